@@ -0,0 +1,333 @@
+/** 
+ *  COPYRIGHT 2014 (C) Jason Volk
+ *  COPYRIGHT 2014 (C) Svetlana Tkachenko
+ *
+ *  DISTRIBUTED UNDER THE GNU GENERAL PUBLIC LICENSE (GPL) (see: LICENSE)
+ */
+
+
+// libircbot irc::bot::
+#include "ircbot/bot.h"
+using namespace irc::bot;
+
+// SPQF
+#include "log.h"
+#include "confs.h"
+#include "vote.h"
+#include "census.h"
+
+
+Census census;
+
+
+void Census::adopt(const Adoc &handoff)
+{
+	for(const auto &c : handoff)
+	{
+		const auto lines(c.second.get_child_optional("lines"));
+		if(!lines)
+			continue;
+
+		Roll roll {true,c.second.get<time_t>("horizon",0)};
+		for(const auto &a : *lines)
+		{
+			auto &times(roll.lines[a.first]);
+			for(const auto &t : a.second)
+				times.emplace_back(t.second.get_value<time_t>());
+		}
+
+		chans[c.first] = std::move(roll);
+	}
+}
+
+
+Adoc Census::handoff()
+const
+{
+	Adoc ret;
+	for(const auto &c : chans)
+	{
+		const auto &roll(c.second);
+		if(!roll.seeded)
+			continue;
+
+		// Channels may contain the '.' path separator so children are appended by key
+		Adoc lines;
+		for(const auto &a : roll.lines)
+		{
+			Adoc times;
+			for(const auto &t : a.second)
+				times.push(lex_cast(t));
+
+			lines.push_back({a.first,times});
+		}
+
+		Adoc doc;
+		doc.put("horizon",roll.horizon);
+		doc.put_child("lines",lines);
+		ret.push_back({c.first,doc});
+	}
+
+	return ret;
+}
+
+
+void Census::handle_privmsg(const Msg &msg,
+                            Chan &chan,
+                            User &user)
+{
+	if(!user.is_logged_in())
+		return;
+
+	const auto &acct(user.get_acct());
+	const auto it(chans.find(tolower(chan.get_name())));
+	if(it == chans.end())
+		return;
+
+	auto &roll(it->second);
+	const auto now(time(nullptr));
+	auto &lines(roll.lines[acct]);
+	lines.emplace_back(now);
+	while(!lines.empty() && lines.front() < now - roll.horizon)
+		lines.pop_front();
+
+	for(auto &p : roll.types)
+	{
+		auto &verdicts(p.second);
+		if(!live(verdicts.conf) && !verdicts.yes.count(acct))
+			verdicts.tallies[acct].young.emplace_back(now);
+	}
+}
+
+
+size_t Census::turnout(const Chan &chan,
+                       const std::string &type,
+                       const VoteConfig &conf)
+{
+	auto &roll(chans[tolower(chan.get_name())]);
+	seed(roll,chan,conf.quorum.age);
+	auto &verdicts(get_verdicts(roll,chan,type,conf));
+
+	const auto now(time(nullptr));
+	const auto start(now - conf.quorum.age);
+	for(auto it(roll.lines.begin()); it != roll.lines.end();)
+	{
+		auto &lines(it->second);
+		while(!lines.empty() && lines.front() < now - roll.horizon)
+			lines.pop_front();
+
+		if(lines.empty())
+			roll.lines.erase(it++);
+		else
+			++it;
+	}
+
+	std::set<std::string> counted;
+	chan.users.for_each([&](const User &user)
+	{
+		const auto &acct(user.get_acct());
+		if(counted.count(acct) || !voter(verdicts,chan,user))
+			return;
+
+		const auto it(roll.lines.find(acct));
+		const auto lines(it == roll.lines.end()? 0 : std::distance(std::lower_bound(it->second.begin(),it->second.end(),start),
+		                                                           it->second.end()));
+		if(size_t(lines) >= conf.quorum.lines)
+			counted.emplace(acct);
+	});
+
+	return counted.size();
+}
+
+
+bool Census::qualified(const VoteConfig &conf,
+                       const Chan &chan,
+                       const User &user,
+                       const time_t &began)
+{
+	if(!conf.enable || !user.is_logged_in() || has_access(chan,user,conf.qualify.access))
+		return ::qualified(conf,chan,user,began);
+
+	std::stringstream rules;
+	rules << "qualify:" << conf.qualify.age << ":" << conf.qualify.lines;
+	return memoize(rules.str(),chan,user,began,[&conf,&chan,&user,&began]
+	{
+		return ::qualified(conf,chan,user,began);
+	});
+}
+
+
+bool Census::enfranchised(const VoteConfig &conf,
+                          const Chan &chan,
+                          const User &user,
+                          const time_t &began)
+{
+	if(!conf.enable || !user.is_logged_in() || live(conf))
+		return ::enfranchised(conf,chan,user,began);
+
+	std::stringstream rules;
+	rules << "enfranchise:" << conf.enfranchise.age << ":" << conf.enfranchise.lines;
+	return memoize(rules.str(),chan,user,began,[&conf,&chan,&user,&began]
+	{
+		return ::enfranchised(conf,chan,user,began);
+	});
+}
+
+
+Census::Verdicts &Census::get_verdicts(Roll &roll,
+                                       const Chan &chan,
+                                       const std::string &type,
+                                       const VoteConfig &conf)
+{
+	const auto version(confs.get_version(chan));
+	const auto it(roll.types.find(type));
+	if(it != roll.types.end() && it->second.version == version)
+		return it->second;
+
+	auto &verdicts(roll.types[type]);
+	verdicts = Verdicts{version,conf,{},{}};
+	if(!live(conf))
+		tally(verdicts,chan);
+
+	return verdicts;
+}
+
+
+void Census::seed(Roll &roll,
+                  const Chan &chan,
+                  const time_t &horizon)
+{
+	if(roll.seeded && horizon <= roll.horizon)
+		return;
+
+	// Everything live is logged before it reaches the census, so a scan replaces the lines outright
+	std::map<std::string, std::deque<time_t>> lines;
+	const auto start(time(nullptr) - horizon);
+	irc::log::for_each(chan.get_name(),[&lines,&start]
+	(const irc::log::ClosureArgs &a)
+	{
+		if(a.time < start)
+			return true;
+
+		if(strncmp(a.type,"PRI",3) != 0)  // PRIVMSG
+			return true;
+
+		if(strnlen(a.acct,16) == 0 || *a.acct == '*')
+			return true;
+
+		lines[a.acct].emplace_back(a.time);
+		return true;
+	});
+
+	for(auto &p : lines)
+		std::sort(p.second.begin(),p.second.end());
+
+	roll.lines = std::move(lines);
+	roll.horizon = std::max(roll.horizon,horizon);
+	roll.seeded = true;
+}
+
+
+bool Census::voter(Verdicts &verdicts,
+                   const Chan &chan,
+                   const User &user)
+{
+	if(live(verdicts.conf))
+		return ::enfranchised(verdicts.conf,chan,user);
+
+	if(!verdicts.conf.enable || !user.is_logged_in())
+		return false;
+
+	const auto &acct(user.get_acct());
+	return verdicts.yes.count(acct) || judge(verdicts,acct,time(nullptr));
+}
+
+
+void Census::tally(Verdicts &verdicts,
+                   const Chan &chan)
+{
+	// Every account which ever spoke is counted, so a newcomer is judged without reading the log
+	auto &tallies(verdicts.tallies);
+	const auto cutoff(time(nullptr) - verdicts.conf.enfranchise.age);
+	irc::log::for_each(chan.get_name(),[&tallies,&cutoff]
+	(const irc::log::ClosureArgs &a)
+	{
+		if(strncmp(a.type,"PRI",3) != 0)  // PRIVMSG
+			return true;
+
+		if(strnlen(a.acct,16) == 0 || *a.acct == '*')
+			return true;
+
+		auto &tally(tallies[a.acct]);
+		if(a.time <= cutoff)
+			++tally.aged;
+		else
+			tally.young.emplace_back(a.time);
+
+		return true;
+	});
+
+	const auto now(time(nullptr));
+	for(auto it(tallies.begin()); it != tallies.end();)
+	{
+		std::sort(it->second.young.begin(),it->second.young.end());
+		judge(verdicts,(it++)->first,now);
+	}
+}
+
+
+bool Census::judge(Verdicts &verdicts,
+                   const std::string &acct,
+                   const time_t &now)
+{
+	const auto &lines(verdicts.conf.enfranchise.lines);
+	const auto it(verdicts.tallies.find(acct));
+	if(it == verdicts.tallies.end() && lines)
+		return false;
+
+	if(it == verdicts.tallies.end())
+	{
+		verdicts.yes.emplace(acct);
+		return true;
+	}
+
+	// Lines only ever age into the count
+	auto &tally(it->second);
+	const auto cutoff(now - verdicts.conf.enfranchise.age);
+	for(; !tally.young.empty() && tally.young.front() <= cutoff; tally.young.pop_front())
+		++tally.aged;
+
+	if(tally.aged < lines)
+		return false;
+
+	verdicts.yes.emplace(acct);       // acct may be the key of the tally
+	verdicts.tallies.erase(it);
+	return true;
+}
+
+
+bool Census::live(const VoteConfig &conf)
+{
+	return !conf.enfranchise.mode.empty() || !conf.enfranchise.access.empty();
+}
+
+
+bool Census::memoize(const std::string &rules,
+                     const Chan &chan,
+                     const User &user,
+                     const time_t &began,
+                     const std::function<bool ()> &closure)
+{
+	const auto now(time(nullptr));
+	const Key key{user.get_acct(),tolower(chan.get_name()),rules,began};
+	const auto it(memo.find(key));
+	if(it != memo.end() && (it->second.yes || now - it->second.when < RECHECK))
+		return it->second.yes;
+
+	const bool yes(closure());
+	if(memo.size() >= MEMO_MAX)
+		memo.clear();
+
+	memo[key] = Memo{yes,now};
+	return yes;
+}
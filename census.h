@@ -0,0 +1,84 @@
+/** 
+ *  COPYRIGHT 2014 (C) Jason Volk
+ *  COPYRIGHT 2014 (C) Svetlana Tkachenko
+ *
+ *  DISTRIBUTED UNDER THE GNU GENERAL PUBLIC LICENSE (GPL) (see: LICENSE)
+ */
+
+
+// Roll of each channel's enfranchised accounts and their recent lines, kept
+// current from PRIVMSG so a quorum's turnout is counted from memory when a
+// motion starts. Verdicts are made per vote type under the version of the
+// channel's configuration and remade only when that changes: each making
+// is one pass over the channel's log counting the lines of every account,
+// after which accounts are judged from those counts without reading the
+// log again.
+//
+// It also memoizes the enfranchised() and qualified() verdicts of the log
+// rules by (account, channel, rules, began) for the checks made against a
+// vote's start. Those still read the log for each account; the window of
+// the rules only grows as time passes, so a positive verdict is kept and a
+// negative one is retried no sooner than RECHECK, which bounds the reads of
+// an account to one a minute. Callers must hold the Bot lock.
+class Census
+{
+	static constexpr time_t RECHECK = 60;            // Secs before an account's negative verdict is retried
+	static constexpr size_t MEMO_MAX = 65536;        // Memoized verdicts before they are all dropped
+
+	struct Memo
+	{
+		bool yes;
+		time_t when;
+	};
+
+	using Key = std::tuple<std::string, std::string, std::string, time_t>;   // acct, chan, rules, began
+
+	struct Tally
+	{
+		size_t aged;                                 // Lines older than enfranchise.age
+		std::deque<time_t> young;                    // Times of the lines not yet that old, ascending
+	};
+
+	struct Verdicts
+	{
+		size_t version;                              // Confs version of the channel these were made under
+		VoteConfig conf;
+		std::set<std::string> yes;                   // Enfranchised accounts; these never regress
+		std::map<std::string, Tally> tallies;        // Not yet enfranchised : acct => lines
+	};
+
+	struct Roll
+	{
+		bool seeded;                                 // The log has been read for lines
+		time_t horizon;                              // Lines are kept back to now - horizon
+		std::map<std::string, std::deque<time_t>> lines;       // PRIVMSG times : acct => ascending
+		std::map<std::string, Verdicts> types;                 // type => verdicts
+	};
+
+	std::map<std::string, Roll> chans;               // tolower(chan) => roll
+	std::map<Key, Memo> memo;                        // Verdicts of enfranchised() and qualified()
+
+	bool memoize(const std::string &rules, const Chan &chan, const User &user, const time_t &began, const std::function<bool ()> &closure);
+
+	static bool live(const VoteConfig &conf);        // Mode/access rules are evaluated, not remembered
+	static bool judge(Verdicts &verdicts, const std::string &acct, const time_t &now);
+	static void tally(Verdicts &verdicts, const Chan &chan);
+	static bool voter(Verdicts &verdicts, const Chan &chan, const User &user);
+	static void seed(Roll &roll, const Chan &chan, const time_t &horizon);
+	static Verdicts &get_verdicts(Roll &roll, const Chan &chan, const std::string &type, const VoteConfig &conf);
+
+  public:
+	bool enfranchised(const VoteConfig &conf, const Chan &chan, const User &user, const time_t &began = 0);
+	bool qualified(const VoteConfig &conf, const Chan &chan, const User &user, const time_t &began = 0);
+
+	// Accounts in the channel enfranchised for the type with enough lines for conf.quorum
+	size_t turnout(const Chan &chan, const std::string &type, const VoteConfig &conf);
+
+	void handle_privmsg(const Msg &msg, Chan &chan, User &user);
+
+	// Lines of the seeded rolls across a module reload; verdicts are remade from the log
+	Adoc handoff() const;
+	void adopt(const Adoc &handoff);
+};
+
+extern Census census;
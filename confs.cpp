@@ -0,0 +1,265 @@
+/** 
+ *  COPYRIGHT 2014 (C) Jason Volk
+ *  COPYRIGHT 2014 (C) Svetlana Tkachenko
+ *
+ *  DISTRIBUTED UNDER THE GNU GENERAL PUBLIC LICENSE (GPL) (see: LICENSE)
+ */
+
+
+// libircbot irc::bot::
+#include "ircbot/bot.h"
+using namespace irc::bot;
+
+// SPQF
+#include "confs.h"
+
+
+Snapshots snapshots;
+Confs confs;
+
+
+Confs::Confs():
+version(0)
+{
+}
+
+
+void Confs::invalidate()
+{
+	chans.clear();
+	++version;
+}
+
+
+void Confs::invalidate(const Chan &chan)
+{
+	chans.erase(tolower(chan.get_name()));
+	++version;
+}
+
+
+const Adoc &Confs::get(const Chan &chan)
+{
+	return get_chan(chan).vote;
+}
+
+
+const Adoc &Confs::get(const Chan &chan,
+                       const std::string &type)
+{
+	return get_type(chan,type)->doc;
+}
+
+
+const VoteConfig &Confs::get_conf(const Chan &chan,
+                                  const std::string &type)
+{
+	return get_type(chan,type)->conf;
+}
+
+
+const Snap &Confs::get_type(const Chan &chan,
+                            const std::string &type)
+{
+	auto &conf(get_chan(chan));
+	const auto it(conf.types.find(type));
+	if(it != conf.types.end())
+		return it->second;
+
+	// A bulk civis vote is made under the civis configuration, so it shares that snapshot
+	const Adoc overrides(type == "cives"? conf.vote.get_child("civis",Adoc{}) : conf.vote.get_child(type,Adoc{}));
+
+	Adoc doc(conf.vote);
+	doc.merge(overrides);                                  // Import type-specifc overrides up to main
+	return conf.types.emplace(type,snapshots(doc)).first->second;
+}
+
+
+Confs::Conf &Confs::get_chan(const Chan &chan)
+{
+	const auto name(tolower(chan.get_name()));
+	const auto it(chans.find(name));
+	if(it != chans.end())
+		return it->second;
+
+	// Default config
+	Adoc vote;
+	vote.put("for",3600);
+	vote.put("duration",30);
+	vote.merge(chan.get("config.vote"));                   // Overwrite defaults with saved config
+
+	return chans.emplace(name,Conf{version,std::move(vote),{}}).first->second;
+}
+
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Snapshots
+//
+
+
+Snapshots::Snapshots():
+sweep(64)
+{
+}
+
+
+Snap Snapshots::operator()(const Snap &base,
+                           const Adoc &delta)
+{
+	if(!base || delta.empty())
+		return base;
+
+	Adoc doc(base->doc);
+	doc.merge(delta);
+	return operator()(doc);
+}
+
+
+Snap Snapshots::operator()(const Adoc &doc)
+{
+	const auto hash(Snapshot::hash_of(doc));
+	auto &weak(snaps[hash]);
+	if(auto ret = weak.lock())
+	{
+		if(ret->doc != doc)
+			throw Assertive("Configuration snapshot hash collision: ") << hash;
+
+		return ret;
+	}
+
+	const auto ret(std::make_shared<const Snapshot>(hash,doc));
+	weak = ret;
+
+	if(snaps.size() >= sweep)
+	{
+		for(auto it(snaps.begin()); it != snaps.end();)
+			it = it->second.expired()? snaps.erase(it) : std::next(it);
+
+		sweep = std::max(snaps.size() * 2,sweep);
+	}
+
+	return ret;
+}
+
+
+Snap Snapshots::find(const std::string &hash)
+const
+{
+	const auto it(snaps.find(hash));
+	return it != snaps.end()? it->second.lock() : Snap{};
+}
+
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Snapshot
+//
+
+
+Snapshot::Snapshot(const std::string &hash,
+                   const Adoc &doc):
+hash(hash),
+doc(doc),
+conf(doc)
+{
+}
+
+
+std::string Snapshot::hash_of(const Adoc &doc)
+{
+	std::stringstream json;
+	json << doc;
+
+	uint64_t ret(0xcbf29ce484222325ULL);
+	for(const auto &c : json.str())
+	{
+		ret ^= uint8_t(c);
+		ret *= 0x100000001b3ULL;
+	}
+
+	std::stringstream str;
+	str << std::hex << std::setw(16) << std::setfill('0') << ret;
+	return str.str();
+}
+
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// VoteConfig
+//
+
+
+VoteConfig::VoteConfig(const Adoc &cfg):
+audibles(cfg.get_child("audibles",Adoc{}).into<std::set<std::string>>()),
+duration(secs_cast(cfg["duration"])),
+enable(cfg.get("enable",false)),
+for_(secs_cast(cfg["for"]))
+{
+	using limits = std::numeric_limits<uint8_t>;
+
+	limit.active = cfg.get<uint8_t>("limit.active",limits::max());
+	limit.user = cfg.get<uint8_t>("limit.user",limits::max());
+	limit.type = cfg.get<uint8_t>("limit.type",limits::max());
+	limit.has_motion = cfg.has("limit.motion");
+	limit.motion = secs_cast(cfg["limit.motion"]);
+	limit.reason = cfg.get_child("limit.reason",Adoc{});
+
+	quorum.ballots = cfg.get("quorum.ballots",1U);
+	quorum.yea = cfg.get("quorum.yea",0U);
+	quorum.has_yea = cfg.has("quorum.yea");
+	quorum.plurality = cfg.get("quorum.plurality",0.51);
+	quorum.turnout = cfg.get("quorum.turnout",0.0);
+	quorum.lines = cfg.get("quorum.lines",0U);
+	quorum.age = secs_cast(cfg["quorum.age"]);
+	quorum.prejudice = cfg.get("quorum.prejudice",false);
+	quorum.quick = cfg.get("quorum.quick",false);
+
+	enfranchise.age = secs_cast(cfg.get("enfranchise.age","30m"));
+	enfranchise.lines = cfg.get("enfranchise.lines",0U);
+	enfranchise.mode = cfg.get("enfranchise.mode",Mode{});
+	enfranchise.access = cfg.get("enfranchise.access",Mode{});
+
+	qualify.age = secs_cast(cfg.get("qualify.age","10m"));
+	qualify.lines = cfg.get("qualify.lines",0U);
+	qualify.access = cfg.get("qualify.access",Mode{});
+
+	speaker.has_access = cfg.has("speaker.access");
+	speaker.has_mode = cfg.has("speaker.mode");
+	speaker.access = cfg.get("speaker.access",Mode{});
+	speaker.mode = cfg.get("speaker.mode",Mode{});
+	speaker.ballot = cfg.get("speaker.ballot","y");
+
+	veto.has_access = cfg.has("veto.access");
+	veto.has_mode = cfg.has("veto.mode");
+	veto.access = cfg.get("veto.access",Mode{});
+	veto.mode = cfg.get("veto.mode",Mode{});
+	veto.quorum = cfg.get("veto.quorum",1U);
+	veto.quick = cfg.get("veto.quick",true);
+
+	ballot.ack.chan = cfg.get("ballot.ack.chan",false);
+	ballot.ack.priv = cfg.get("ballot.ack.priv",true);
+	ballot.rej.chan = cfg.get("ballot.rej.chan",false);
+	ballot.rej.priv = cfg.get("ballot.rej.priv",true);
+	ballot.aggregate.window = secs_cast(cfg.get("ballot.ack.aggregate.window","30s"));
+	ballot.aggregate.threshold = cfg.get("ballot.ack.aggregate.threshold",10U);
+
+	result.ack.chan = cfg.get("result.ack.chan",true);
+	result.ack.priv = false;
+
+	visible.motion = cfg.get("visible.motion",1U);
+	visible.active = cfg.get<bool>("visible.active",true);
+	visible.ballots = cfg.get<bool>("visible.ballots",true);
+	visible.veto = cfg.get("visible.veto",true);
+
+	weight.yea = secs_cast(cfg["weight.yea"]);
+	weight.nay = secs_cast(cfg["weight.nay"]);
+
+	list.packed = cfg.get("list.packed",false);
+}
@@ -0,0 +1,209 @@
+/** 
+ *  COPYRIGHT 2014 (C) Jason Volk
+ *  COPYRIGHT 2014 (C) Svetlana Tkachenko
+ *
+ *  DISTRIBUTED UNDER THE GNU GENERAL PUBLIC LICENSE (GPL) (see: LICENSE)
+ */
+
+
+// Typed view of a vote configuration for the paths which consult it on every
+// ballot and tick. It covers the keys documented under config.vote in help.json
+// with the same defaults used by the code which reads them; anything else is
+// still read from the Adoc it was compiled from.
+struct VoteConfig
+{
+	std::set<std::string> audibles;
+	time_t duration;
+	bool enable;
+	time_t for_;                                     // "for"
+
+	struct
+	{
+		uint8_t active;
+		uint8_t user;
+		uint8_t type;
+		bool has_motion;
+		time_t motion;
+		Adoc reason;
+	}
+	limit;
+
+	struct
+	{
+		uint ballots;
+		uint yea;
+		bool has_yea;                                // calc_quorum() defaults to 1, calc_required() to 0
+		double plurality;
+		double turnout;
+		uint lines;
+		time_t age;
+		bool prejudice;
+		bool quick;
+	}
+	quorum;
+
+	struct
+	{
+		time_t age;
+		uint lines;
+		Mode mode;
+		Mode access;
+	}
+	enfranchise;
+
+	struct
+	{
+		time_t age;
+		uint lines;
+		Mode access;
+	}
+	qualify;
+
+	struct
+	{
+		bool has_access;
+		bool has_mode;
+		Mode access;
+		Mode mode;
+		std::string ballot;
+	}
+	speaker;
+
+	struct
+	{
+		bool has_access;
+		bool has_mode;
+		Mode access;
+		Mode mode;
+		uint quorum;
+		bool quick;
+	}
+	veto;
+
+	struct Ack
+	{
+		bool chan;
+		bool priv;
+	};
+
+	struct
+	{
+		Ack ack;
+		Ack rej;
+
+		struct
+		{
+			time_t window;
+			uint threshold;                          // 0 acknowledges every ballot
+		}
+		aggregate;
+	}
+	ballot;
+
+	struct
+	{
+		Ack ack;
+	}
+	result;
+
+	struct
+	{
+		uint motion;
+		bool active;
+		bool ballots;
+		bool veto;
+	}
+	visible;
+
+	struct
+	{
+		time_t yea;
+		time_t nay;
+	}
+	weight;
+
+	struct
+	{
+		bool packed;
+	}
+	list;
+
+	explicit VoteConfig(const Adoc &cfg = {});
+};
+
+
+// Immutable vote configuration shared by every holder of it. The hash of the
+// JSON names it in the database, so a stored vote only references its config.
+struct Snapshot
+{
+	std::string hash;
+	Adoc doc;
+	VoteConfig conf;                                 // Compiled from doc
+
+	static std::string hash_of(const Adoc &doc);    // 64-bit FNV-1a, stable across builds
+
+	Snapshot(const std::string &hash, const Adoc &doc);
+};
+
+using Snap = std::shared_ptr<const Snapshot>;
+
+
+// Interned snapshots: each distinct configuration exists once while anything
+// holds it. Callers must hold the Bot lock.
+class Snapshots
+{
+	size_t sweep;                                    // Size of snaps to drop released entries at
+	std::unordered_map<std::string, std::weak_ptr<const Snapshot>> snaps;  // hash => snapshot
+
+  public:
+	auto size() const                                { return snaps.size();                     }
+
+	Snap find(const std::string &hash) const;       // Null unless something holds it
+	Snap operator()(const Adoc &doc);               // Interns the doc if required
+	Snap operator()(const Snap &base, const Adoc &delta);      // base itself if delta is empty
+
+	Snapshots();
+	Snapshots(const Snapshots &) = delete;
+	Snapshots &operator=(const Snapshots &) = delete;
+};
+
+extern Snapshots snapshots;
+
+
+// Cache of each channel's "config.vote" with the defaults applied, and of the
+// merged configuration for each vote type as an interned snapshot. Entries are only
+// dropped by invalidate(), which is called wherever the channel's config is written;
+// reading never writes back to the channel. Callers must hold the Bot lock.
+class Confs
+{
+	struct Conf
+	{
+		size_t version;                              // Confs::version when this was read; the channel's version
+		Adoc vote;                                   // Defaults merged with config.vote
+		std::map<std::string, Snap> types;           // config.vote with each type's overrides : type => snap
+	};
+
+	size_t version;                                  // Bumped on every invalidation
+	std::map<std::string, Conf> chans;               // Cached configs : tolower(chan) => conf
+
+	Conf &get_chan(const Chan &chan);
+	const Snap &get_type(const Chan &chan, const std::string &type);
+
+  public:
+	auto get_version(const Chan &chan)               { return get_chan(chan).version;           }
+
+	const Snap &get_snap(const Chan &chan, const std::string &type)  { return get_type(chan,type); }
+
+	const VoteConfig &get_conf(const Chan &chan, const std::string &type);
+	const Adoc &get(const Chan &chan, const std::string &type);
+	const Adoc &get(const Chan &chan);
+
+	void invalidate(const Chan &chan);
+	void invalidate();
+
+	Confs();
+	Confs(const Confs &) = delete;
+	Confs &operator=(const Confs &) = delete;
+};
+
+extern Confs confs;
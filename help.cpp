@@ -0,0 +1,67 @@
+/** 
+ *  COPYRIGHT 2014 (C) Jason Volk
+ *  COPYRIGHT 2014 (C) Svetlana Tkachenko
+ *
+ *  DISTRIBUTED UNDER THE GNU GENERAL PUBLIC LICENSE (GPL) (see: LICENSE)
+ */
+
+
+// libircbot irc::bot::
+#include "ircbot/bot.h"
+using namespace irc::bot;
+
+// SPQF
+#include "help.h"
+
+
+Help::Help(const std::string &file)
+try
+{
+	std::ifstream in(file);
+	in.exceptions(std::ios_base::badbit|std::ios_base::failbit);
+	const Adoc doc(std::string
+	{
+		std::istreambuf_iterator<char>(in),
+		std::istreambuf_iterator<char>()
+	});
+
+	index({},doc);
+	printf("[Help]: Indexed %zu documents from %s\n",docs.size(),file.c_str());
+}
+catch(const std::exception &e)
+{
+	error = e.what();
+	std::cerr << "[Help]: \033[1;31mFailed to read " << file << ": " << e.what() << "\033[0m" << std::endl;
+}
+
+
+const std::string *Help::children(const std::string &path)
+const
+{
+	const auto it(docs.find(path));
+	return it != docs.end() && !it->second.children.empty()? &it->second.children : nullptr;
+}
+
+
+const std::string *Help::text(const std::string &path)
+const
+{
+	const auto it(docs.find(path));
+	return it != docs.end() && !it->second.text.empty()? &it->second.text : nullptr;
+}
+
+
+void Help::index(const std::string &path,
+                 const Adoc &node)
+{
+	Doc doc;
+	doc.text = node.get("",std::string{});
+	for(const auto &p : node)
+	{
+		const auto &key(p.first);
+		doc.children += key + ", ";
+		index(path.empty()? key : path + "." + key,node.get_child(key,Adoc{}));
+	}
+
+	docs.emplace(path,std::move(doc));
+}
@@ -0,0 +1,33 @@
+/** 
+ *  COPYRIGHT 2014 (C) Jason Volk
+ *  COPYRIGHT 2014 (C) Svetlana Tkachenko
+ *
+ *  DISTRIBUTED UNDER THE GNU GENERAL PUBLIC LICENSE (GPL) (see: LICENSE)
+ */
+
+
+// help.json read once and flattened to a document for each dotted path: the
+// text of a leaf, or the listing of a branch's children. ResPublica holds it,
+// so the file is read again whenever the module is reloaded (SIGHUP).
+class Help
+{
+	struct Doc
+	{
+		std::string text;                            // Value of the node
+		std::string children;                        // "key, key, ..." of a branch, else empty
+	};
+
+	std::string error;                               // Why the file could not be read, else empty
+	std::unordered_map<std::string, Doc> docs;       // path => doc ("" is the root)
+
+	void index(const std::string &path, const Adoc &node);
+
+  public:
+	auto &get_error() const                          { return error;                            }
+	auto size() const                                { return docs.size();                      }
+
+	const std::string *text(const std::string &path) const;       // Null unless non-empty
+	const std::string *children(const std::string &path) const;   // Null unless a branch
+
+	Help(const std::string &file);
+};
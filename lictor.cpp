@@ -0,0 +1,327 @@
+/** 
+ *  COPYRIGHT 2014 (C) Jason Volk
+ *  COPYRIGHT 2014 (C) Svetlana Tkachenko
+ *
+ *  DISTRIBUTED UNDER THE GNU GENERAL PUBLIC LICENSE (GPL) (see: LICENSE)
+ */
+
+
+// libircbot irc::bot::
+#include "ircbot/bot.h"
+using namespace irc::bot;
+
+// SPQF
+#include "praeco.h"
+#include "lictor.h"
+
+
+Lictor lictor;
+
+
+Lictor::Lictor():
+batches(0)
+{
+}
+
+
+void Lictor::flush()
+{
+	std::map<std::string, Deltas> modes;
+	{
+		const std::lock_guard<decltype(mutex)> lock(mutex);
+		std::swap(modes,this->modes);
+	}
+
+	auto &chans(get_chans());
+	for(const auto &p : modes)
+	{
+		const auto &name(p.first);
+		const auto &deltas(p.second);
+		if(!chans.has(name))
+			continue;
+
+		auto &chan(chans.get(name));
+		send(chan,deltas);
+	}
+
+	flags_expire();
+}
+
+
+bool Lictor::flags_reply(const std::string &text)
+{
+	// Services name the account and channel as whole words, often in bold and ending a sentence
+	std::string plain(text);
+	plain.erase(std::remove(plain.begin(),plain.end(),'\x02'),plain.end());
+
+	std::set<std::string> words;
+	std::istringstream ss(tolower(plain));
+	for(std::string word; ss >> word; words.emplace(word))
+		while(!word.empty() && std::string(".,:;!?'\"").find(word.back()) != std::string::npos)
+			word.pop_back();
+
+	const bool named_chan(std::any_of(words.begin(),words.end(),[](const std::string &word)
+	{
+		return !word.empty() && word.front() == '#';
+	}));
+
+	const std::lock_guard<decltype(mutex)> lock(mutex);
+	const auto it(std::find_if(flags_sent.begin(),flags_sent.end(),[&words,&named_chan]
+	(const Flags &flags)
+	{
+		return words.count(tolower(flags.acct)) && (!named_chan || words.count(tolower(flags.chan)));
+	}));
+
+	if(it == flags_sent.end())
+		return false;
+
+	// Anything but a change or confirmation of the flags is a refusal; sending it again won't help
+	const auto lower(tolower(plain));
+	const bool done(boost::starts_with(lower,"flags ") ||
+	                lower.find(" has been removed from ") != std::string::npos ||
+	                lower.find(" unchanged") != std::string::npos);
+
+	if(done)
+		std::cout << "[Lictor]: FLAGS " << it->chan << " " << it->acct << " " << it->deltas
+		          << ": " << plain
+		          << std::endl;
+	else
+		std::cerr << "[Lictor]: FLAGS " << it->chan << " " << it->acct << " " << it->deltas
+		          << ": \033[1;31mrefused by services: " << plain << "\033[0m"
+		          << std::endl;
+
+	flags_sent.erase(it);
+	return true;
+}
+
+
+void Lictor::flags(Chan &chan,
+                   const User &user,
+                   const Delta &delta)
+{
+	Deltas deltas;
+	deltas.emplace_back(delta);
+	flags(chan,user,deltas);
+}
+
+
+void Lictor::flags(Chan &chan,
+                   const User &user,
+                   const Deltas &deltas)
+{
+	flags_queue({chan.get_name(),user.get_acct(),deltas,0,0});
+}
+
+
+void Lictor::operator()(Chan &chan,
+                        const Delta &delta)
+{
+	Deltas deltas;
+	deltas.emplace_back(delta);
+	operator()(chan,deltas);
+}
+
+
+void Lictor::operator()(Chan &chan,
+                        const Deltas &deltas)
+{
+	{
+		const std::lock_guard<decltype(mutex)> lock(mutex);
+		if(batches)
+		{
+			auto &pending(modes[chan.get_name()]);
+			for(const auto &delta : deltas)
+				queue(pending,delta);
+
+			return;
+		}
+	}
+
+	send(chan,deltas);
+}
+
+
+void Lictor::send(Chan &chan,
+                  const Deltas &deltas)
+{
+	const auto &sess(get_sess());
+	const auto &isup(sess.get_isupport());
+	const auto max(std::max(isup.get("MODES",3U),1U));
+	const auto cry([&chan]
+	(const Deltas &line)
+	{
+		praeco(Praeco::EFFECT,chan.get_name(),[name(chan.get_name()),line]
+		{
+			auto &chans(get_chans());
+			if(chans.has(name))
+				chans.get(name)(line);
+		});
+	});
+
+	size_t len(0);
+	Deltas line;
+	for(const auto &delta : deltas)
+	{
+		const auto &mask(std::get<Delta::MASK>(delta));
+		if(!line.empty() && (line.size() >= max || len + mask.size() + 1 > MODE_ARGS_MAX))
+		{
+			cry(line);
+			line.clear();
+			len = 0;
+		}
+
+		line.emplace_back(delta);
+		len += mask.size() + 1;
+	}
+
+	if(!line.empty())
+		cry(line);
+}
+
+
+void Lictor::queue(Deltas &pending,
+                   const Delta &delta)
+{
+	const auto same([&delta]
+	(const Delta &d)
+	{
+		return char(d) == char(delta) && std::get<Delta::MASK>(d) == std::get<Delta::MASK>(delta);
+	});
+
+	// A later delta on the same mode and mask supersedes the earlier one
+	const auto it(std::find_if(pending.begin(),pending.end(),same));
+	if(it != pending.end())
+	{
+		if(bool(*it) == bool(delta))
+			return;
+
+		pending.erase(it);
+	}
+
+	pending.emplace_back(delta);
+}
+
+
+
+void Lictor::flags_expire()
+{
+	std::vector<Flags> expired;
+	{
+		const std::lock_guard<decltype(mutex)> lock(mutex);
+		const auto now(time(nullptr));
+		while(!flags_sent.empty() && now - flags_sent.front().sent >= FLAGS_TIMEOUT)
+		{
+			expired.emplace_back(std::move(flags_sent.front()));
+			flags_sent.pop_front();
+		}
+	}
+
+	for(const auto &flags : expired)
+	{
+		if(flags.tries < FLAGS_TRIES)
+		{
+			flags_queue(flags);
+			continue;
+		}
+
+		std::cerr << "[Lictor]: FLAGS " << flags.chan << " " << flags.acct << " " << flags.deltas
+		          << ": \033[1;31mno answer from services after " << flags.tries << " tries\033[0m"
+		          << std::endl;
+	}
+}
+
+
+void Lictor::flags_queue(const Flags &flags)
+{
+	const FlagsKey key(flags.chan,tolower(flags.acct));
+	{
+		const std::lock_guard<decltype(mutex)> lock(mutex);
+		const auto it(flagq.find(key));
+		if(it != flagq.end())
+		{
+			// A command sent again yields to any change of the same flag queued since
+			auto &pending(it->second.deltas);
+			for(const auto &delta : flags.deltas)
+				if(!flags.tries)
+					queue(pending,delta);
+				else if(std::none_of(pending.begin(),pending.end(),[&delta]
+				(const Delta &d)
+				{
+					return char(d) == char(delta);
+				}))
+					pending.emplace_back(delta);
+
+			it->second.tries = std::max(it->second.tries,flags.tries);
+			return;
+		}
+
+		flagq.emplace(key,flags);
+	}
+
+	praeco(Praeco::EFFECT,"ChanServ",[this,key]
+	{
+		flags_send(key);
+	},
+	"flags " + key.first + " " + key.second);
+}
+
+
+void Lictor::flags_send(const FlagsKey &key)
+{
+	Flags flags;
+	{
+		const std::lock_guard<decltype(mutex)> lock(mutex);
+		const auto it(flagq.find(key));
+		if(it == flagq.end())
+			return;
+
+		flags = std::move(it->second);
+		flagq.erase(it);
+	}
+
+	auto &chans(get_chans());
+	if(flags.deltas.empty() || !chans.has(flags.chan))
+		return;
+
+	auto &chan(chans.get(flags.chan));
+	const User user(flags.acct,"",flags.acct);
+	chan.flags(user,flags.deltas);
+
+	flags.sent = time(nullptr);
+	++flags.tries;
+
+	const std::lock_guard<decltype(mutex)> lock(mutex);
+	flags_sent.emplace_back(std::move(flags));
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Lictor::Batch
+//
+
+
+Lictor::Batch::Batch(Lictor &lictor):
+lictor(lictor)
+{
+	const std::lock_guard<decltype(lictor.mutex)> lock(lictor.mutex);
+	++lictor.batches;
+}
+
+
+Lictor::Batch::~Batch()
+noexcept try
+{
+	{
+		const std::lock_guard<decltype(lictor.mutex)> lock(lictor.mutex);
+		if(--lictor.batches)
+			return;
+	}
+
+	lictor.flush();
+}
+catch(const std::exception &e)
+{
+	std::cerr << "[Lictor]: \033[1;31m" << e.what() << "\033[0m" << std::endl;
+}
@@ -0,0 +1,77 @@
+/** 
+ *  COPYRIGHT 2014 (C) Jason Volk
+ *  COPYRIGHT 2014 (C) Svetlana Tkachenko
+ *
+ *  DISTRIBUTED UNDER THE GNU GENERAL PUBLIC LICENSE (GPL) (see: LICENSE)
+ */
+
+
+// Carries out the effects of votes on the channels. Mode deltas issued
+// while a Batch is open are coalesced per channel and sent as few MODE
+// lines as the server allows when the outermost Batch closes. The lines
+// are cried by the Praeco ahead of any other message.
+//
+// ChanServ FLAGS changes are always queued, one command per account and
+// channel holding the latest delta of each flag, and paced to services by
+// the Praeco. A command is complete when services answer it naming its
+// account, and its channel when the answer names one. An answer which is not
+// a change or a confirmation of the flags is a refusal, which is logged and
+// not sent again; an unanswered command is sent again until FLAGS_TRIES and
+// then given up.
+// Callers must hold the Bot lock.
+class Lictor
+{
+	static constexpr size_t MODE_ARGS_MAX = 384;     // Bytes of mask arguments per MODE line
+	static constexpr size_t FLAGS_TRIES = 2;         // Sends of a FLAGS command before giving up
+	static constexpr time_t FLAGS_TIMEOUT = 60;      // Seconds for services to answer a FLAGS command
+
+	struct Flags
+	{
+		std::string chan;
+		std::string acct;
+		Deltas deltas;
+		size_t tries;                                // Times sent
+		time_t sent;                                 // Time of the last send
+	};
+
+	using FlagsKey = std::pair<std::string, std::string>;
+
+	std::mutex mutex;
+	size_t batches;                                  // Depth of open Batch scopes
+	std::map<std::string, Deltas> modes;             // Pending mode deltas : chan => deltas
+	std::map<FlagsKey, Flags> flagq;                 // Queued FLAGS   : chan, tolower(acct) => flags
+	std::deque<Flags> flags_sent;                    // Awaiting an answer from services in order sent
+
+	static void queue(Deltas &pending, const Delta &delta);
+	static void send(Chan &chan, const Deltas &deltas);
+
+	void flags_send(const FlagsKey &key);
+	void flags_queue(const Flags &flags);
+	void flags_expire();
+
+  public:
+	struct Batch;
+
+	bool flags_reply(const std::string &text);       // Completes or fails the command answered; false if none
+	void flags(Chan &chan, const User &user, const Deltas &deltas);
+	void flags(Chan &chan, const User &user, const Delta &delta);
+	void operator()(Chan &chan, const Deltas &deltas);
+	void operator()(Chan &chan, const Delta &delta);
+	void flush();                                    // Also sends again the commands left unanswered
+
+	Lictor();
+	Lictor(const Lictor &) = delete;
+	Lictor &operator=(const Lictor &) = delete;
+};
+
+
+struct Lictor::Batch
+{
+	Lictor &lictor;
+
+	Batch(Lictor &lictor);
+	~Batch() noexcept;
+};
+
+
+extern Lictor lictor;
@@ -0,0 +1,80 @@
+/** 
+ *  COPYRIGHT 2014 (C) Jason Volk
+ *  COPYRIGHT 2014 (C) Svetlana Tkachenko
+ *
+ *  DISTRIBUTED UNDER THE GNU GENERAL PUBLIC LICENSE (GPL) (see: LICENSE)
+ */
+
+
+// libircbot irc::bot::
+#include "ircbot/bot.h"
+using namespace irc::bot;
+
+// SPQF
+#include "packer.h"
+
+
+decltype(Packer::SEP) Packer::SEP                { " | "                                           };
+
+
+Packer::Packer(Locutor &out):
+out(out),
+max([&out]
+{
+	static const size_t command(strlen(" PRIVMSG ") + strlen(" :") + strlen("\r\n"));
+	const auto &target(out.get_target());
+	const bool chan(!target.empty() && std::string("#&!+").find(target.front()) != std::string::npos);
+	return LINE_MAX - PREFIX_MAX - command - target.size() - (chan? 0 : 1 + CHAN_MAX);
+}())
+{
+}
+
+
+Packer::~Packer()
+noexcept try
+{
+	if(!line.empty())
+		flush();
+}
+catch(const std::exception &e)
+{
+	std::cerr << "[Packer]: \033[1;31m" << e.what() << "\033[0m" << std::endl;
+}
+
+
+void Packer::flush()
+{
+	send();
+	out << Locutor::flush;
+}
+
+
+Packer &Packer::operator()(const std::string &text)
+{
+	// A field longer than a whole line goes out alone and is left to the server to truncate
+	if(!line.empty() && line.size() + SEP.size() + text.size() > max)
+		send();
+
+	if(!line.empty())
+		line += SEP;
+
+	line += text;
+	return *this;
+}
+
+
+Packer &Packer::operator()(const std::string &key,
+                           const std::string &val)
+{
+	return operator()(key + ": " + val);
+}
+
+
+void Packer::send()
+{
+	if(line.empty())
+		return;
+
+	out << line << "\n";
+	line.clear();
+}
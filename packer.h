@@ -0,0 +1,34 @@
+/** 
+ *  COPYRIGHT 2014 (C) Jason Volk
+ *  COPYRIGHT 2014 (C) Svetlana Tkachenko
+ *
+ *  DISTRIBUTED UNDER THE GNU GENERAL PUBLIC LICENSE (GPL) (see: LICENSE)
+ */
+
+
+// Packs the fields of a multi-line reply into as few lines as the protocol
+// allows. Each line carries as many "KEY: value" fields as fit in 512 bytes
+// after the worst case prefix the server relays to the recipient and the
+// framing for the stream's own target. A reply to a user may also name the
+// channel it concerns, so room for a channel name is kept on those lines.
+class Packer
+{
+	static constexpr size_t LINE_MAX = 512;          // Bytes of a protocol line including CRLF
+	static constexpr size_t PREFIX_MAX = 106;        // ":" nick(30) "!" user(10) "@" host(63)
+	static constexpr size_t CHAN_MAX = 50;           // Longest channel name a reply to a user may name
+	static const std::string SEP;                    // Between the fields of a line
+
+	Locutor &out;
+	size_t max;                                      // Bytes of text each line may carry
+	std::string line;
+
+	void send();
+
+  public:
+	Packer &operator()(const std::string &key, const std::string &val);
+	Packer &operator()(const std::string &text);
+	void flush();                                    // Sends the last line and flushes the stream
+
+	Packer(Locutor &out);
+	~Packer() noexcept;
+};
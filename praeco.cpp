@@ -0,0 +1,274 @@
+/** 
+ *  COPYRIGHT 2014 (C) Jason Volk
+ *  COPYRIGHT 2014 (C) Svetlana Tkachenko
+ *
+ *  DISTRIBUTED UNDER THE GNU GENERAL PUBLIC LICENSE (GPL) (see: LICENSE)
+ */
+
+
+// libircbot irc::bot::
+#include "ircbot/bot.h"
+using namespace irc::bot;
+
+// SPQF
+#include "praeco.h"
+
+
+Praeco praeco;
+
+constexpr milliseconds Praeco::TARGET_INTERVAL;
+constexpr milliseconds Praeco::SESS_INTERVAL;
+
+
+Praeco::Praeco():
+bot(nullptr),
+interrupted(false),
+sess(SESS_BURST,SESS_INTERVAL),
+queued(0),
+dropped(0),
+merged(0)
+{
+}
+
+
+Praeco::~Praeco()
+noexcept
+{
+	{
+		const std::lock_guard<decltype(mutex)> lock(mutex);
+		interrupted = true;
+	}
+
+	cond.notify_all();
+	if(thread.joinable())
+		thread.join();
+}
+
+
+void Praeco::stop()
+{
+	// The worker may be waiting on the Bot lock this caller holds, so it is interrupted beforehand
+	interrupt();
+
+	decltype(queues) queues;
+	{
+		const std::lock_guard<decltype(mutex)> lock(mutex);
+		std::swap(queues,this->queues);
+		targets.clear();
+		bot = nullptr;
+		queued = 0;
+	}
+
+	// Effects and results are cried now rather than lost to the unload; acks and reminders go unsaid
+	for(size_t i(0); i < ACK; ++i)
+		for(const auto &msg : queues.at(i)) try
+		{
+			msg.send();
+		}
+		catch(const std::exception &e)
+		{
+			std::cerr << "[Praeco]: Stopping: \033[1;31m" << e.what() << "\033[0m" << std::endl;
+		}
+}
+
+
+void Praeco::interrupt()
+{
+	{
+		const std::lock_guard<decltype(mutex)> lock(mutex);
+		interrupted = true;
+	}
+
+	// Messages queued from here on wait in the queues for stop()
+	cond.notify_all();
+	if(thread.joinable())
+		thread.join();
+}
+
+
+void Praeco::start(Bot &bot)
+{
+	const std::lock_guard<decltype(mutex)> lock(mutex);
+	if(this->bot)
+		throw Assertive("Praeco already started");
+
+	this->bot = &bot;
+	interrupted = false;
+	thread = std::thread(&Praeco::worker,this);
+}
+
+
+void Praeco::budget(const std::string &target,
+                    const size_t &burst,
+                    const milliseconds &interval)
+{
+	const std::lock_guard<decltype(mutex)> lock(mutex);
+	const auto key(tolower(target));
+	budgets[key] = {std::max(burst,size_t(1)),interval};
+	targets.erase(key);
+}
+
+
+void Praeco::operator()(const Class &cls,
+                        const std::string &target,
+                        const Send &send,
+                        const std::string &merge)
+{
+	std::unique_lock<decltype(mutex)> lock(mutex);
+	if(!bot)
+	{
+		lock.unlock();
+		send();
+		return;
+	}
+
+	auto &queue(queues.at(cls));
+	if(!merge.empty())
+	{
+		const auto it(std::find_if(queue.begin(),queue.end(),[&merge]
+		(const Message &msg)
+		{
+			return msg.merge == merge;
+		}));
+
+		// The merged message keeps the place in line of the one it replaces
+		if(it != queue.end())
+		{
+			it->send = send;
+			++merged;
+			return;
+		}
+	}
+
+	if(!shed(cls))
+	{
+		++dropped;
+		return;
+	}
+
+	queue.emplace_back(Message{tolower(target),merge,send});
+	++queued;
+	cond.notify_one();
+}
+
+
+void Praeco::worker()
+{
+	{
+		const std::lock_guard<Bot> l(*bot);
+		bot->set_tls_context();
+	}
+
+	std::unique_lock<decltype(mutex)> lock(mutex);
+	while(!interrupted) try
+	{
+		Message msg;
+		auto wake(clock::time_point::max());
+		if(!next(msg,wake))
+		{
+			if(wake == clock::time_point::max())
+				cond.wait(lock);
+			else
+				cond.wait_until(lock,wake);
+
+			continue;
+		}
+
+		const unlock_guard<decltype(lock)> unlock(lock);
+		const std::lock_guard<Bot> l(*bot);
+		msg.send();
+	}
+	catch(const std::exception &e)
+	{
+		std::cerr << "[Praeco]: \033[1;31m" << e.what() << "\033[0m" << std::endl;
+	}
+}
+
+
+bool Praeco::next(Message &msg,
+                  clock::time_point &wake)
+{
+	const auto now(clock::now());
+	for(auto it(targets.begin()); it != targets.end();)
+		if(it->second.idle(now))
+			it = targets.erase(it);
+		else
+			++it;
+
+	if(!queued)
+		return false;
+
+	if(sess.ready() > now)
+	{
+		wake = sess.ready();
+		return false;
+	}
+
+	// The first message of the most important class whose target isn't being paced
+	for(auto &queue : queues)
+		for(auto it(queue.begin()); it != queue.end(); ++it)
+		{
+			auto bit(targets.find(it->target));
+			if(bit != targets.end() && bit->second.ready() > now)
+			{
+				wake = std::min(wake,bit->second.ready());
+				continue;
+			}
+
+			if(bit == targets.end())
+			{
+				const auto budget(budgets.find(it->target));
+				bit = budget != budgets.end()? targets.emplace(it->target,Bucket(budget->second.first,budget->second.second)).first:
+				                               targets.emplace(it->target,Bucket(TARGET_BURST,TARGET_INTERVAL)).first;
+			}
+
+			bit->second.take(now);
+			sess.take(now);
+
+			msg = std::move(*it);
+			queue.erase(it);
+			--queued;
+			return true;
+		}
+
+	return false;
+}
+
+
+bool Praeco::shed(const Class &cls)
+{
+	if(queued < BACKLOG)
+		return true;
+
+	// Room is made by dropping the oldest message of the least important class which may be shed
+	for(size_t i(_NUM_CLASSES - 1); i >= ACK && i > size_t(cls); --i)
+	{
+		auto &queue(queues.at(i));
+		if(queue.empty())
+			continue;
+
+		queue.pop_front();
+		--queued;
+		++dropped;
+		return true;
+	}
+
+	// Nothing above acks is shed even beyond the backlog
+	return cls < ACK;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Praeco::Bucket
+//
+
+
+Praeco::Bucket::Bucket(const size_t burst,
+                       const milliseconds interval):
+burst(burst),
+interval(interval),
+tat(clock::now())
+{
+}
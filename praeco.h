@@ -0,0 +1,97 @@
+/** 
+ *  COPYRIGHT 2014 (C) Jason Volk
+ *  COPYRIGHT 2014 (C) Svetlana Tkachenko
+ *
+ *  DISTRIBUTED UNDER THE GNU GENERAL PUBLIC LICENSE (GPL) (see: LICENSE)
+ */
+
+
+// The herald. Outbound messages are queued by class and cried in order of
+// that class, paced by a token bucket for each target and one for the whole
+// session. When the queue backs up the acks and reminders are shed first.
+// A message given a merge key replaces the one still queued under that key.
+// Until a worker is started the messages are sent at once by the caller,
+// who must hold the Bot lock as the worker does when it sends. The worker
+// takes that lock for every message, so it is interrupted before whoever
+// stops the Praeco takes the lock.
+class Praeco
+{
+  public:
+	enum Class
+	{
+		EFFECT,                                      // Modes and other effects of votes
+		RESULT,                                      // Announcements of the course of votes
+		REPLY,                                       // Replies not sent in the handling of a command
+		ACK,                                         // Acknowledgement of ballots
+		REMIND,                                      // Reminders to vote
+		_NUM_CLASSES
+	};
+
+	using Send = std::function<void ()>;             // Streams the message to its target
+
+  private:
+	using clock = std::chrono::steady_clock;
+
+	static constexpr size_t BACKLOG = 64;            // Queued messages before ACK and REMIND are shed
+	static constexpr size_t TARGET_BURST = 4;        // Messages a target receives before pacing
+	static constexpr milliseconds TARGET_INTERVAL {2000};
+	static constexpr size_t SESS_BURST = 8;          // Messages the session sends before pacing
+	static constexpr milliseconds SESS_INTERVAL {600};
+
+	struct Bucket
+	{
+		size_t burst;
+		milliseconds interval;
+		clock::time_point tat;                       // Theoretical arrival time of the next message
+
+		clock::time_point ready() const              { return tat - std::chrono::duration_cast<clock::duration>(interval * long(burst - 1)); }
+		bool idle(const clock::time_point &now) const  { return tat <= now;                   }
+		void take(const clock::time_point &now)      { tat = std::max(tat,now) + interval;      }
+
+		Bucket(const size_t burst, const milliseconds interval);
+	};
+
+	struct Message
+	{
+		std::string target;                          // tolower(chan or nick)
+		std::string merge;
+		Send send;
+	};
+
+	Bot *bot;                                        // Worker's bot; nullptr when not started
+	std::mutex mutex;
+	std::condition_variable cond;
+	bool interrupted;
+	std::array<std::deque<Message>, _NUM_CLASSES> queues;
+	std::unordered_map<std::string, Bucket> targets; // Buckets of targets not idle : target => bucket
+	std::unordered_map<std::string, std::pair<size_t, milliseconds>> budgets;   // Other than the default : target => burst, interval
+	Bucket sess;
+	size_t queued;
+	size_t dropped;
+	size_t merged;
+
+	bool shed(const Class &cls);
+	bool next(Message &msg, clock::time_point &wake);
+	void worker();
+	std::thread thread;
+
+  public:
+	auto size() const                                { return queued;                           }
+	auto get_dropped() const                         { return dropped;                          }
+	auto get_merged() const                          { return merged;                           }
+
+	void operator()(const Class &cls, const std::string &target, const Send &send, const std::string &merge = {});
+	void budget(const std::string &target, const size_t &burst, const milliseconds &interval);
+
+	void start(Bot &bot);                            // Caller holds the Bot lock
+	void interrupt();                                // Caller must not hold the Bot lock; joins the worker
+	void stop();                                     // Caller holds the Bot lock; sends what must not be lost
+
+	Praeco();
+	Praeco(const Praeco &) = delete;
+	Praeco &operator=(const Praeco &) = delete;
+	~Praeco() noexcept;
+};
+
+
+extern Praeco praeco;
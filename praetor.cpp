@@ -12,6 +12,8 @@ using namespace irc::bot;
 
 // SPQF
 #include "log.h"
+#include "lictor.h"
+#include "confs.h"
 #include "vote.h"
 #include "votes.h"
 #include "vdb.h"
@@ -23,6 +25,7 @@ Praetor::Praetor(Bot &bot,
 bot(bot),
 vdb(vdb),
 interrupted(false),
+paged(true),
 thread(&Praetor::worker,this),
 init_thread(&Praetor::init,this)
 {
@@ -43,7 +46,13 @@ void Praetor::init()
 {
 	const std::lock_guard<Bot> l(bot);
 	bot.set_tls_context();
-	std::cout << "[Praetor]: Initiating the schedule."
+
+	// The worker pages the persisted schedule in by itself; only a database which
+	// predates the persisted schedule has to be scanned to build it once.
+	if(vdb.sched_migrated())
+		return;
+
+	std::cout << "[Praetor]: Migrating the schedule."
 	          << " Reading " << vdb.count() << " votes..."
 	          << std::endl;
 
@@ -60,6 +69,9 @@ void Praetor::init()
 		          << ": \033[1;31m" << e << "\033[0m"
 		          << std::endl;
 	}
+
+	if(!interrupted.load(std::memory_order_consume))
+		vdb.sched_set_migrated();
 }
 
 
@@ -87,15 +99,49 @@ void Praetor::process()
 	using system_clock = std::chrono::system_clock;
 
 	std::unique_lock<decltype(mutex)> lock(mutex);
+	if(sched.empty() && paged)
+		fill();
+
 	cond.wait_until(lock,system_clock::from_time_t(sched.next_abs()));
 
+	Vdb::Expiries due;
 	while(sched.next_rel() <= 0)
 	{
-		const id_t id(sched.next_id());
+		due.emplace_back(std::make_tuple(sched.next_id(),sched.next_abs()));
 		sched.pop();
+	}
+
+	if(due.empty())
+		return;
+
+	const unlock_guard<decltype(lock)> unlock(lock);
+	process(due);
+}
+
 
-		const unlock_guard<decltype(lock)> unlock(lock);
-		if(!process(id))
+void Praetor::fill()
+{
+	// Everything held in sched is also persisted, so the page is simply reread
+	const auto page(vdb.sched_page(PAGE + 1));
+	paged = page.size() > PAGE;
+
+	sched.clear();
+	for(auto it(page.begin()); it != page.end() && sched.size() < PAGE; ++it)
+		sched.add(std::get<id_t>(*it),std::get<time_t>(*it));
+}
+
+
+void Praetor::process(const Vdb::Expiries &due)
+{
+	const std::unique_lock<Bot> lock(bot);
+	const Lictor::Batch batch(lictor);        // Everything expiring together shares MODE lines
+	for(const auto &expiry : due)
+	{
+		const auto &id(std::get<id_t>(expiry));
+		const auto &absolute(std::get<time_t>(expiry));
+		const bool processed(process(id));
+		vdb.sched_del(id,absolute);
+		if(!processed)
 		{
 			const time_t retry_absolute(time(NULL) + 300);
 			add(id,retry_absolute);
@@ -105,11 +151,22 @@ void Praetor::process()
 
 
 bool Praetor::process(const id_t &id)
+try
 {
-	const std::unique_lock<Bot> lock(bot);
 	const std::unique_ptr<Vote> vote(vdb.get(id));
 	return process(*vote);
 }
+catch(const std::exception &e)
+{
+	std::cerr << "\033[1;31m"
+	          << "[Praetor]:"
+	          << " Vote #" << id
+	          << " could not be read: " << e.what()
+	          << "\033[0m"
+	          << std::endl;
+
+	return false;
+}
 
 
 bool Praetor::process(Vote &vote)
@@ -141,7 +198,7 @@ try
 	const auto id(lex_cast<id_t>(doc["id"]));
 	const auto ended(secs_cast(doc["ended"]));
 	const auto expiry(secs_cast(doc["expiry"]));
-	const auto cfgfor(secs_cast(doc["cfg.for"]));
+	const auto cfgfor(secs_cast(doc.has("cfg_hash")? doc["cfg_delta.for"] : doc["cfg.for"]));
 	if(expiry || (cfgfor <= 0) || !ended || doc.has("reason"))
 		return;
 
@@ -173,13 +230,11 @@ void Praetor::add(std::unique_ptr<Vote> &&vote)
 try
 {
 	const id_t &id(vote->get_id());
-	const auto &cfg(vote->get_cfg());
-	const auto cfgfor(secs_cast(cfg["for"]));
-	if(cfgfor <= 0)
+	const auto &cfgfor(vote->get_conf().for_);
+	if(cfgfor <= 0 || !vote->get_ended() || !vote->get_reason().empty())
 		return;
 
-	const time_t absolute(time(NULL) + cfgfor);
-	add(id,absolute);
+	add(id,vote->expires());
 }
 catch(const std::exception &e)
 {
@@ -196,11 +251,28 @@ void Praetor::add(const id_t &id,
                   const time_t &absolute)
 {
 	const std::lock_guard<std::mutex> l(mutex);
-	sched.add(id,absolute);
+	vdb.sched_add(id,absolute);
+	schedule(id,absolute);
 	cond.notify_one();
 }
 
 
+void Praetor::schedule(const id_t &id,
+                       const time_t &absolute)
+{
+	// Beyond the page the expiration is only persisted and fill() finds it later
+	if(paged && absolute >= sched.back_abs())
+		return;
+
+	sched.add(id,absolute);
+	if(sched.size() > PAGE)
+	{
+		sched.pop_back();
+		paged = true;
+	}
+}
+
+
 
 id_t Schedule::pop()
 {
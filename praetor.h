@@ -20,21 +20,30 @@ class Schedule
 	id_t next_id() const            { return !empty()? std::get<id_t>(sched.at(0)) : 0;         }
 	time_t next_abs() const         { return !empty()? std::get<time_t>(sched.at(0)) : max();   }
 	time_t next_rel() const         { return !empty()? next_abs() - time(NULL) : max();         }
+	time_t back_abs() const         { return !empty()? std::get<time_t>(sched.back()) : max();  }
 
 	void add(const id_t &id, const time_t &absolute);
+	void clear()                    { sched.clear();                                            }
+	void pop_back()                 { sched.pop_back();                                         }
 	id_t pop();
 };
 
 
 class Praetor
 {
+	static constexpr size_t PAGE = 64;          // Maximum expirations held in memory at once
+
 	Bot &bot;
 	Vdb &vdb;
 
 	std::mutex mutex;
 	std::atomic<bool> interrupted;
 	std::condition_variable cond;
-	Schedule sched;
+	Schedule sched;                             // Earliest page of the schedule persisted in vdb
+	bool paged;                                 // The persisted schedule extends beyond sched
+
+	void fill();
+	void schedule(const id_t &id, const time_t &absolute);
 
   public:
 	void add(const id_t &id, const time_t &absolute);
@@ -44,6 +53,7 @@ class Praetor
   private:
 	bool process(Vote &vote) noexcept;
 	bool process(const id_t &id);
+	void process(const Vdb::Expiries &due);
 	void process();
 	void worker();
 	std::thread thread;
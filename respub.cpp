@@ -12,11 +12,17 @@ using namespace irc::bot;
 
 // SPQF
 #include "log.h"
+#include "praeco.h"
+#include "lictor.h"
+#include "confs.h"
 #include "vote.h"
+#include "census.h"
 #include "votes.h"
 #include "vdb.h"
 #include "praetor.h"
 #include "voting.h"
+#include "help.h"
+#include "packer.h"
 #include "respub.h"
 
 
@@ -40,41 +46,56 @@ noexcept
 
 
 extern "C"
-void module_init(Bot *const bot)
+void module_init_handoff(Bot *const bot,
+                         std::string *const handoff)
 noexcept
 {
 	const std::lock_guard<Bot> lock(*bot);
 	printf("Construct RexPublica...\n");
 	bot->set_tls_context();
 	irc::log::init();
-	respub = new ResPublica(*bot);
+	respub = new ResPublica(*bot,ResPublica::adopt(*handoff));
+	handoff->clear();
 }
 
 
 extern "C"
-void module_fini(Bot *const bot)
+void module_fini_handoff(Bot *const bot,
+                         std::string *const handoff)
 noexcept
 {
+	// The herald takes the Bot lock for each line it sends, so it is joined first
+	praeco.interrupt();
+
 	const std::lock_guard<Bot> lock(*bot);
 	printf("Destruct RexPublica...\n");
+	*handoff = respub->handoff();
 	delete respub;
 }
 
 
-ResPublica::ResPublica(Bot &bot):
+ResPublica::ResPublica(Bot &bot,
+                       const Adoc &handoff):
 bot(bot),
 opts(bot.opts),
 sess(bot.sess),
 users(bot.users),
 chans(bot.chans),
 events(bot.events),
-vdb({opts["dbdir"] + "/vote"}),
+help("help.json"),
+vdb(opts["dbdir"] + "/vote",handoff.get_child("vdb",Adoc{})),
 praetor(bot,vdb),
-voting(bot,vdb,praetor)
+voting(bot,vdb,praetor,handoff.get_child("voting",Adoc{}))
 {
+	// Rolls counted by the previous module, before this one counts any line
+	census.adopt(handoff.get_child("census",Adoc{}));
+
 	// Channel->User catch-all for logging
 	events.chan_user.add(handler::ALL,boost::bind(&irc::log::log,_1,_2,_3),handler::RECURRING);
 
+	// Census of the channels, after logging
+	events.chan_user.add("PRIVMSG",boost::bind(&Census::handle_privmsg,&census,_1,_2,_3),handler::RECURRING);
+
 	// Channel command handlers
 	events.chan_user.add("PRIVMSG",boost::bind(&ResPublica::handle_privmsg,this,_1,_2,_3),handler::RECURRING);
 	events.chan_user.add("NOTICE",boost::bind(&ResPublica::handle_notice,this,_1,_2,_3),handler::RECURRING);
@@ -91,18 +112,70 @@ voting(bot,vdb,praetor)
 	events.chan.add(RPL_INVITING,boost::bind(&ResPublica::handle_inviting,this,_1,_2),handler::RECURRING);
 	events.chan.add(ERR_MLOCKRESTRICTED,boost::bind(&ResPublica::handle_mlock,this,_1,_2),handler::RECURRING);
 	events.chan.add("MODE",boost::bind(&ResPublica::handle_cmode,this,_1,_2),handler::RECURRING);
+
+	// ChanServ commands are paced to the budget services allow the bot
+	const auto burst(opts.count("services-burst")? opts.get<uint>("services-burst") : 4U);
+	const auto interval(opts.count("services-interval")? opts.get<uint>("services-interval") : 3U);
+	praeco.budget("ChanServ",burst,std::chrono::seconds(interval));
+
+	// Messages are cried by priority from here on
+	praeco.start(bot);
 }
 
 
 ResPublica::~ResPublica()
 noexcept
 {
+	praeco.stop();
 	events.chan_user.clear(handler::Prio::USER);
 	events.user.clear(handler::Prio::USER);
 	events.chan.clear(handler::Prio::USER);
 }
 
 
+std::string ResPublica::handoff()
+const try
+{
+	Adoc doc;
+	doc.put("version",HANDOFF_VERSION);
+	doc.put_child("voting",voting.handoff());
+	doc.put_child("census",census.handoff());
+	doc.put_child("vdb",vdb.handoff());
+
+	std::stringstream ret;
+	ret << doc;
+	return ret.str();
+}
+catch(const std::exception &e)
+{
+	std::cerr << "[ResPublica]: \033[1;31mFailed to hand off state: " << e.what() << "\033[0m" << std::endl;
+	return {};
+}
+
+
+Adoc ResPublica::adopt(const std::string &handoff)
+try
+{
+	if(handoff.empty())
+		return {};
+
+	const Adoc doc(handoff);
+	if(doc.get("version",0U) != HANDOFF_VERSION)
+	{
+		std::cerr << "[ResPublica]: Ignoring state handed off by another version." << std::endl;
+		return {};
+	}
+
+	printf("Adopting %zu bytes of state from the previous module...\n",handoff.size());
+	return doc;
+}
+catch(const std::exception &e)
+{
+	std::cerr << "[ResPublica]: \033[1;31mFailed to adopt state: " << e.what() << "\033[0m" << std::endl;
+	return {};
+}
+
+
 ///////////////////////////////////////////////////////////////////////////////////
 //
 //   Primary dispatch (irc::bot::Bot overloads)
@@ -216,6 +289,13 @@ try
 	if(msg[TEXT].empty())
 		return;
 
+	// Answers of services complete the FLAGS commands of the Lictor
+	if(msg.from("chanserv"))
+	{
+		lictor.flags_reply(msg[TEXT]);
+		return;
+	}
+
 	// Silently drop the background noise
 	if(!user.is_logged_in())
 		return;
@@ -410,6 +490,7 @@ void ResPublica::handle_vote(const Msg &msg,
 		case hash("list"):     handle_vote_list(msg,chan,user,subtok(toks));                 break;
 		case hash("info"):     handle_vote_id(msg,chan,user,subtok(toks));                   break;
 		case hash("cancel"):   handle_vote_cancel(msg,chan,user,subtok(toks));               break;
+		case hash("strike"):   handle_vote_strike(msg,chan,user,subtok(toks));               break;
 		case hash("stats"):    handle_vote_stats(msg,chan,user,subtok(toks));                break;
 		case hash("eligible"): handle_vote_eligible(msg,chan,user,subtok(toks));             break;
 		case hash("access"):   handle_vote_access(msg,chan,user,subtok(toks));               break;
@@ -452,7 +533,7 @@ try
 	if(voting.exists(id))
 		handle_vote_info(msg,user,user,subtok(toks),voting.get(id));
 	else
-		handle_vote_info(msg,user,user,subtok(toks),*vdb.get(id));
+		handle_vote_info(msg,user,user,subtok(toks),vdb.view(id));
 }
 catch(const boost::bad_lexical_cast &e)
 {
@@ -471,6 +552,26 @@ void ResPublica::handle_vote_cancel(const Msg &msg,
 }
 
 
+void ResPublica::handle_vote_strike(const Msg &msg,
+                                    Chan &chan,
+                                    User &user,
+                                    const Tokens &toks)
+{
+	if(toks.size() < 2)
+		throw Exception("Usage: !vote strike <id> <account>");
+
+	auto &vote(voting.get(lex_cast<id_t>(*toks.at(0))));
+	auto *const cives(dynamic_cast<vote::Cives *>(&vote));
+	if(!cives)
+		throw Exception("Only accounts on a bulk civis ballot can be struck.");
+
+	const auto &acct(*toks.at(1));
+	const auto struck(cives->strike(user,acct));
+	const auto vmin(std::max(vote.get_conf().veto.quorum,1U));
+	user << chan << acct << " has been struck from " << vote << " (" << struck << "/" << vmin << ")." << flush;
+}
+
+
 void ResPublica::handle_vote_ballot(const Msg &msg,
                                     Chan &chan,
                                     User &user,
@@ -485,11 +586,14 @@ try
 		return;
 	}
 
-	for(const auto &tok : toks)
+	if(toks.size() > 1)
 	{
-		auto &vote(voting.get(lex_cast<id_t>(*tok)));
-		vote.event_vote(user,ballot);
+		vote_ballots(user,toks,ballot);
+		return;
 	}
+
+	auto &vote(voting.get(lex_cast<id_t>(*toks.at(0))));
+	vote.event_vote(user,ballot);
 }
 catch(const boost::bad_lexical_cast &e)
 {
@@ -714,6 +818,7 @@ try
 		}
 
 		chan.set(doc);
+		confs.invalidate(chan);
 		user << "Success." << user.flush;
 		return;
 	}
@@ -895,7 +1000,7 @@ try
 	if(voting.exists(id))
 		handle_vote_info(msg,user,user<<(*chan),subtok(toks),voting.get(id));
 	else
-		handle_vote_info(msg,user,user<<(*chan),subtok(toks),*vdb.get(id));
+		handle_vote_info(msg,user,user<<(*chan),subtok(toks),vdb.view(id));
 }
 catch(const boost::bad_lexical_cast &e)
 {
@@ -929,11 +1034,14 @@ void ResPublica::handle_vote_ballot(const Msg &msg,
                                     const Ballot &ballot)
 try
 {
-	for(const auto &tok : toks)
+	if(toks.size() > 1)
 	{
-		auto &vote(voting.get(lex_cast<id_t>(*tok)));
-		vote.event_vote(user,ballot);
+		vote_ballots(user,toks,ballot);
+		return;
 	}
+
+	auto &vote(voting.get(lex_cast<id_t>(*toks.at(0))));
+	vote.event_vote(user,ballot);
 }
 catch(const boost::bad_lexical_cast &e)
 {
@@ -1002,17 +1110,11 @@ void ResPublica::handle_vote_access(const Msg &msg,
 void ResPublica::handle_help(const Msg &msg,
                              Locutor &out,
                              const Tokens &toks)
-try
 {
 	using namespace colors;
 
-	std::ifstream file("help.json");
-	file.exceptions(std::ios_base::badbit|std::ios_base::failbit);
-	const Adoc doc(std::string
-	{
-		std::istreambuf_iterator<char>(file),
-		std::istreambuf_iterator<char>()
-	});
+	if(!help.size())
+		throw Assertive(help.get_error());
 
 	const auto topic(!toks.empty()? *toks.at(0) : std::string{});
 	if(topic.empty())
@@ -1023,33 +1125,20 @@ try
 		out << "This help is a document tree using the '.' character to find your topic. example: !help config.vote.duration\n";
 	}
 
-	const auto val(doc.get(topic,std::string{}));
-	if(val.empty())
+	if(const auto text = help.text(topic))
+		out << *text;
+	else if(const auto children = help.children(topic))
 	{
-		const auto sub(doc.get_child(topic,Adoc{}));
-		if(!sub.empty())
-		{
-			out << UNDER2 << "Available documents";
-			if(!topic.empty())
-				out << " in " << topic;
+		out << UNDER2 << "Available documents";
+		if(!topic.empty())
+			out << " in " << topic;
 
-			out << OFF << ": ";
-			for(const auto &p : sub)
-			{
-				const auto &key(p.first);
-				out << key << ", ";
-			}
-		}
-		else out << "Not found.";
+		out << OFF << ": " << *children;
 	}
-	else out << val;
+	else out << "Not found.";
 
 	out << flush;
 }
-catch(const std::ios_base::failure &e)
-{
-	throw Assertive(e.what());
-}
 
 
 void ResPublica::handle_vote_list(const Msg &msg,
@@ -1059,6 +1148,8 @@ void ResPublica::handle_vote_list(const Msg &msg,
                                   const Tokens &toks)
 try
 {
+	using namespace colors;
+
 	if(toks.empty())
 	{
 		if(!voting.exists(chan))
@@ -1084,6 +1175,21 @@ try
 		return;
 	}
 
+	if(*toks.at(0) == "more")
+	{
+		const auto it(cursors.find({user.get_acct(),tolower(chan.get_name())}));
+		if(it == cursors.end() || it->second.when + CURSOR_TTL < time(nullptr))
+		{
+			out << "No list to continue for " << chan.get_name() << out.flush;
+			return;
+		}
+
+		std::vector<std::string> more(it->second.toks);
+		more.emplace_back("--after=" + lex_cast(it->second.last));
+		handle_vote_list(msg,chan,user,out,pointers<Tokens>(more.begin(),more.end()));
+		return;
+	}
+
 	static const std::map<std::string,std::string> aliases
 	{
 		{ "speaker", "nick"      },
@@ -1097,6 +1203,7 @@ try
 		{ "order",    "descending"  },
 		{ "oneline",  "0"           },
 		{ "count",    "0"           },
+		{ "after",    "0"           },
 	};
 
 	std::forward_list<Vdb::Term> terms
@@ -1159,21 +1266,57 @@ try
 	if(optlim > max_limit)
 		throw Exception("Exceeded the maximum --limit=") << max_limit;
 
-	const bool descending(options.at("order") == "descending");
-	const auto limit(options.at("count") != "1"? optlim : 0);
-	auto res(vdb.query(terms,limit,descending));
-	if(!res.empty() && limit > 0)
+	if(options.at("count") == "1" || !optlim)
 	{
-		if(options.at("oneline") != "0")
-			vote_list_oneline(chan,user,out,res);
+		const auto count(vdb.count(chan.get_name(),terms));
+		if(count)
+			out << "Found " << count << " results for " << chan.get_name() << out.flush;
 		else
-			for(const auto &id : res)
-				handle_vote_list(msg,user,out,{},id);
+			out << "No matching results for " << chan.get_name() << out.flush;
+
+		return;
 	}
-	else if(!res.empty())
-		out << "Found " << res.size() << " results for " << chan.get_name() << out.flush;
+
+	const bool descending(options.at("order") == "descending");
+	const auto after(lex_cast<id_t>(options.at("after")));
+	const auto res(vdb.query(chan.get_name(),terms,optlim,after,descending));
+	const std::pair<std::string, std::string> key{user.get_acct(),tolower(chan.get_name())};
+	if(res.size() < optlim)
+		cursors.erase(key);
+
+	if(res.empty())
+	{
+		out << "No " << (after? "more" : "matching") << " results for " << chan.get_name() << out.flush;
+		return;
+	}
+
+	if(options.at("oneline") != "0")
+		vote_list_oneline(chan,user,out,res);
 	else
-		out << "No matching results for " << chan.get_name() << out.flush;
+		for(const auto &id : res)
+			handle_vote_list(msg,user,out,{},id);
+
+	if(res.size() < optlim)
+		return;
+
+	// Cursors of lists left unfinished are forgotten after a while
+	const auto now(time(nullptr));
+	for(auto it(cursors.begin()); it != cursors.end();)
+		if(it->second.when + CURSOR_TTL < now)
+			it = cursors.erase(it);
+		else
+			++it;
+
+	// The next page continues from the last id listed
+	auto &cursor(cursors[key]);
+	cursor.toks.clear();
+	for(const auto &tok : toks)
+		if(tok->find("--after") != 0)
+			cursor.toks.emplace_back(*tok);
+
+	cursor.last = res.back();
+	cursor.when = now;
+	out << "There may be more: " << BOLD << "!vote list more" << OFF << out.flush;
 }
 catch(const boost::bad_lexical_cast &e)
 {
@@ -1190,7 +1333,7 @@ void ResPublica::handle_vote_list(const Msg &msg,
 	if(voting.exists(id))
 		handle_vote_list(msg,user,out,toks,voting.get(id));
 	else
-		handle_vote_list(msg,user,out,toks,*vdb.get(id));
+		handle_vote_list(msg,user,out,toks,vdb.view(id));
 
 
 }
@@ -1200,7 +1343,7 @@ void ResPublica::handle_vote_list(const Msg &msg,
                                   const User &user,
                                   Locutor &out,
                                   const Tokens &toks,
-                                  const Vote &vote)
+                                  const VoteView &vote)
 {
 	using namespace colors;
 	using std::setfill;
@@ -1208,7 +1351,7 @@ void ResPublica::handle_vote_list(const Msg &msg,
 	using std::right;
 	using std::left;
 
-	const auto cfg(vote.get_cfg());
+	const auto &cfg(vote.get_conf());
 	const auto tally(vote.tally());
 	const scope f([&]
 	{
@@ -1218,13 +1361,13 @@ void ResPublica::handle_vote_list(const Msg &msg,
 
 	out << vote << ": ";
 	out << BOLD << "YEA" << OFF << ": ";
-	if(!vote.get_ended() && !cfg.get<bool>("visible.active",1))
+	if(!vote.get_ended() && !cfg.visible.active)
 		out << BOLD << FG::GREEN << "- " << OFF << " ";
 	else
 		out << BOLD << FG::GREEN << setw(2) << setfill(' ') << left << tally.first << OFF << " ";
 
 	out << BOLD << "NAY" << OFF << ": ";
-	if(!vote.get_ended() && !cfg.get<bool>("visible.active",1))
+	if(!vote.get_ended() && !cfg.visible.active)
 		out << BOLD << FG::GREEN << "- " << OFF << " ";
 	else
 		out << BOLD << FG::RED << setw(2) << setfill(' ') << left << tally.second << OFF << " ";
@@ -1250,8 +1393,8 @@ void ResPublica::handle_vote_list(const Msg &msg,
 
 	if(!vote.get_ended())
 	{
-		if(secs_cast(cfg["for"]) > 0)
-			out << "For " << BOLD << secs_cast(secs_cast(cfg["for"])) << OFF << ". ";
+		if(cfg.for_ > 0)
+			out << "For " << BOLD << secs_cast(cfg.for_) << OFF << ". ";
 
 		out << BOLD << secs_cast(vote.remaining()) << OFF << " left. ";
 	}
@@ -1262,7 +1405,7 @@ void ResPublica::handle_vote_list(const Msg &msg,
 		const auto quorum(vote.get_quorum());
 		const auto required(calc_required(cfg,tally));
 
-		if(!cfg.get<bool>("visible.active",1))
+		if(!cfg.visible.active)
 			out << FG::GRAY << "Secret ballot until closure." << OFF;
 		else if(total < quorum)
 			out << BOLD << (quorum - total) << OFF << " more votes are required for a quorum.";
@@ -1277,7 +1420,7 @@ void ResPublica::handle_vote_list(const Msg &msg,
 
 		if(!vote.get_reason().empty())
 			out << BOLD << FG::RED << vote.get_reason() << OFF << ". ";
-		else if(secs_cast(cfg["for"]) > 0 && eff > 0)
+		else if(cfg.for_ > 0 && eff > 0)
 			out << BOLD << FG::GREEN << "effective " << OFF << secs_cast(eff) << " more. ";
 
 		out << secs_cast(ago) << " ago.";
@@ -1289,12 +1432,18 @@ void ResPublica::handle_vote_info(const Msg &msg,
                                   const User &user,
                                   Locutor &out,
                                   const Tokens &toks,
-                                  const Vote &vote)
+                                  const VoteView &vote)
 {
 	using namespace colors;
 
+	if(packed(vote.get_chan_name(),vote.get_type()))
+	{
+		vote_info_packed(user,out,vote);
+		return;
+	}
+
 	const std::string pfx(std::string("#") + string(vote.get_id()) + ": ");
-	const auto &cfg(vote.get_cfg());
+	const auto &cfg(vote.get_conf());
 	const auto tally(vote.tally());
 	const scope f([&]
 	{
@@ -1346,12 +1495,12 @@ void ResPublica::handle_vote_info(const Msg &msg,
 	}
 
 	// Yea votes line
-	if(tally.first && (vote.get_ended() || cfg.get<bool>("visible.active",true)))
+	if(tally.first && (vote.get_ended() || cfg.visible.active))
 	{
 		out << pfx << BOLD << "YEA" << OFF << "      : ";
 		out << BOLD << FG::GREEN << tally.first << OFF << " - ";
 
-		if(cfg.get<bool>("visible.ballots",true))
+		if(cfg.visible.ballots)
 			for(const auto &acct : vote.get_yea())
 				out << acct << ", ";
 
@@ -1359,12 +1508,12 @@ void ResPublica::handle_vote_info(const Msg &msg,
 	}
 
 	// Nay votes line
-	if(tally.second && (vote.get_ended() || cfg.get<bool>("visible.active",true)))
+	if(tally.second && (vote.get_ended() || cfg.visible.active))
 	{
 		out << pfx << BOLD << "NAY" << OFF << "      : ";
 		out << BOLD << FG::RED << tally.second << OFF << " - ";
 
-		if(cfg.get<bool>("visible.ballots",true))
+		if(cfg.visible.ballots)
 			for(const auto &acct : vote.get_nay())
 				out << acct << ", ";
 
@@ -1376,7 +1525,7 @@ void ResPublica::handle_vote_info(const Msg &msg,
 	{
 		const auto &vetoes(vote.get_veto());
 		out << pfx << BOLD << "VETO" << OFF << "     : " << BOLD << FG::MAGENTA << vetoes.size() << OFF;
-		if(cfg.get("visible.veto",true))
+		if(cfg.visible.veto)
 		{
 			out << " - ";
 			for(const auto &acct : vetoes)
@@ -1400,8 +1549,8 @@ void ResPublica::handle_vote_info(const Msg &msg,
 	if(!vote.get_effect().empty())
 		out << pfx << BOLD << "EFFECT" << OFF << "   : " << vote.get_effect() << "\n";
 
-	if(secs_cast(cfg["for"]) > 0)
-		out << pfx << BOLD << "FOR" << OFF << "      : " << cfg["for"] << " seconds (" << secs_cast(cfg["for"]) << ")\n";
+	if(cfg.for_ > 0)
+		out << pfx << BOLD << "FOR" << OFF << "      : " << cfg.for_ << " seconds (" << secs_cast(cfg.for_) << ")\n";
 
 	// Result/Status line
 	if(vote.get_ended())
@@ -1417,7 +1566,7 @@ void ResPublica::handle_vote_info(const Msg &msg,
 		const auto required(calc_required(cfg,tally));
 
 		out << pfx << BOLD << "STATUS" << OFF << "   : ";
-		if(!cfg.get<bool>("visible.active",true))
+		if(!cfg.visible.active)
 			out << BOLD << FG::GRAY << "Unavailable until polling has closed.\n";
 		else if(total < quorum)
 			out << BOLD << FG::BLUE << (quorum - total) << " more votes are required for a quorum."  << "\n";
@@ -1438,7 +1587,7 @@ void ResPublica::vote_list_oneline(const Chan &c,
 		if(voting.exists(id))
 			vote_list_oneline(c,u,out,voting.get(id));
 		else
-			vote_list_oneline(c,u,out,*vdb.get(id));
+			vote_list_oneline(c,u,out,vdb.view(id));
 
 	out << flush;
 }
@@ -1447,11 +1596,11 @@ void ResPublica::vote_list_oneline(const Chan &c,
 void ResPublica::vote_list_oneline(const Chan &c,
                                    const User &u,
                                    Locutor &out,
-                                   const Vote &vote)
+                                   const VoteView &vote)
 {
 	using namespace colors;
 
-	const auto &cfg(vote.get_cfg());
+	const auto &cfg(vote.get_conf());
 
 	static const size_t truncmax(16);
 	const auto &issue(vote.get_issue());
@@ -1469,13 +1618,91 @@ void ResPublica::vote_list_oneline(const Chan &c,
 	    << vote.get_type() << OFF << " "
 	    << UNDER2 << isout << OFF;
 
-	if(vote.get_ended() || cfg.get<bool>("visible.active",true))
+	if(vote.get_ended() || cfg.visible.active)
 		out << " " << BOLD << FG::GREEN << tally.first << OFF << "v" << BOLD << FG::RED << tally.second << OFF;
 
 	out << ". ";
 }
 
 
+bool ResPublica::packed(const std::string &chan,
+                        const std::string &type)
+{
+	if(!chans.has(chan))
+		return false;
+
+	return confs.get_conf(chans.get(chan),type).list.packed;
+}
+
+
+void ResPublica::vote_info_packed(const User &user,
+                                  Locutor &out,
+                                  const VoteView &vote)
+{
+	const auto &cfg(vote.get_conf());
+	const auto tally(vote.tally());
+	const auto accts([](const std::set<std::string> &ballots)
+	{
+		std::string ret;
+		for(const auto &acct : ballots)
+		{
+			ret += ret.empty()? "" : ", ";
+			ret += acct;
+		}
+
+		return ret;
+	});
+
+	Packer pack(out);
+	pack(std::string("#") + string(vote.get_id()));
+	pack("STATE",vote.get_ended()? std::string("CLOSED") : "ACTIVE (" + lex_cast(vote.remaining()) + "s)");
+	pack("ISSUE",vote.get_issue());
+	pack("TYPE",vote.get_type());
+	pack("CHANNEL",vote.get_chan_name());
+	pack("SPEAKER",vote.get_user_acct());
+
+	if(vote.get_quorum() > 0)
+		pack("QUORUM",lex_cast(vote.get_quorum()));
+
+	pack("STARTED",lex_cast(vote.get_began()));
+	if(vote.get_ended())
+		pack("ENDED",lex_cast(vote.get_ended()));
+
+	if(tally.first && (vote.get_ended() || cfg.visible.active))
+		pack("YEA",lex_cast(tally.first) + (cfg.visible.ballots? " - " + accts(vote.get_yea()) : ""));
+
+	if(tally.second && (vote.get_ended() || cfg.visible.active))
+		pack("NAY",lex_cast(tally.second) + (cfg.visible.ballots? " - " + accts(vote.get_nay()) : ""));
+
+	if(!vote.get_veto().empty())
+		pack("VETO",lex_cast(vote.get_veto().size()) + (cfg.visible.veto? " - " + accts(vote.get_veto()) : ""));
+
+	pack("YOU",!vote.voted(user)?                     "---":
+	           vote.position(user) == Ballot::YEA?    "YEA":
+	           vote.position(user) == Ballot::NAY?    "NAY":
+	                                                  "???");
+
+	if(!vote.get_effect().empty())
+		pack("EFFECT",vote.get_effect());
+
+	if(cfg.for_ > 0)
+		pack("FOR",lex_cast(cfg.for_) + "s");
+
+	if(vote.get_ended())
+		pack("RESULT",vote.get_reason().empty()? std::string("PASSED") : "FAILED: " + vote.get_reason());
+	else if(!cfg.visible.active)
+		pack("STATUS","Unavailable until polling has closed.");
+	else if(vote.total() < vote.get_quorum())
+		pack("STATUS",lex_cast(vote.get_quorum() - vote.total()) + " more votes are required for a quorum.");
+	else if(tally.first < calc_required(cfg,tally))
+		pack("STATUS",lex_cast(calc_required(cfg,tally) - tally.first) + " more yeas are required to pass.");
+	else
+		pack("STATUS","As it stands, the motion will pass.");
+
+	pack.flush();
+}
+
+
 void ResPublica::opinion(const Chan &chan,
                          const User &user,
                          Locutor &out,
@@ -1483,40 +1710,31 @@ void ResPublica::opinion(const Chan &chan,
 {
 	using namespace colors;
 
-	const Adoc cfg(chan.get("config.vote.opine"));
+	const Adoc cfg(confs.get(chan).get_child("opine",Adoc{}));
 	const auto cfgfor(secs_cast(cfg["for"]));
 	const auto curtime(time(nullptr));
 	const auto maxeff(curtime - (cfgfor? cfgfor : curtime));
-	std::forward_list<Vdb::Term> terms
-	{
-		std::make_tuple("chan",   "=",  chan.get_name()),
-		std::make_tuple("type",   "=",  "opine"),
-		std::make_tuple("reason", "=",  std::string{}),
-		std::make_tuple("ended",  ">",  lex_cast(maxeff))
-	};
+	const auto &latest(vdb.get_opinions(chan.get_name(),maxeff));
 
 	size_t effective(0);
-	auto res(vdb.query(terms,3,true));
-	if(!res.empty())
+	for(auto it(latest.rbegin()); it != latest.rend(); ++it)
 	{
-		for(const auto &id : res)
-		{
-			const auto vote(vdb.get(id));
-			if(cfgfor <= 0 && (vote->expires() < time(nullptr)))
-				continue;
+		const auto &id(it->first);
+		const auto &vote(it->second);
+		if(cfgfor <= 0 && (vote.expires() < time(nullptr)))
+			continue;
 
-			out << "#" << BOLD << id << OFF << ": ";
-			out << UNDER2 << vote->get_issue() << OFF << ". ";
-			out << BOLD << FG::GREEN << vote->tally().first << OFF << "v";
-			out << BOLD << FG::RED << vote->tally().second << OFF << ". ";
-			out << secs_cast(time(nullptr) - vote->get_ended()) << " ago.";
+		out << "#" << BOLD << id << OFF << ": ";
+		out << UNDER2 << vote.get_issue() << OFF << ". ";
+		out << BOLD << FG::GREEN << vote.tally().first << OFF << "v";
+		out << BOLD << FG::RED << vote.tally().second << OFF << ". ";
+		out << secs_cast(time(nullptr) - vote.get_ended()) << " ago.";
 
-			// without cfgfor the message count indicator won't be known accurately.
-			if(cfgfor > 0)
-				out << " (" << (effective + 1) << "/" << res.size() << ")" << out.flush;
+		// without cfgfor the message count indicator won't be known accurately.
+		if(cfgfor > 0)
+			out << " (" << (effective + 1) << "/" << latest.size() << ")" << out.flush;
 
-			++effective;
-		}
+		++effective;
 	}
 
 	if(!effective)
@@ -1553,6 +1771,7 @@ void ResPublica::vote_stats_chan(Locutor &out,
 	std::map<std::string, size_t> stats;
 	std::set<std::string> speakers;
 	std::set<std::string> voters;
+	vdb.flush();
 	for(auto it(vdb.cbegin()); it != vdb.end(); ++it)
 	{
 		const auto &id(lex_cast<id_t>(it->first));
@@ -1580,6 +1799,17 @@ void ResPublica::vote_stats_chan(Locutor &out,
 	stats["SPEAKERS"] = speakers.size();
 	stats["VOTERS"] = voters.size();
 
+	if(packed(chan))
+	{
+		Packer pack(out);
+		pack(chan + " statistics for channel");
+		for(const auto &key : keys)
+			pack(key,lex_cast(stats.at(key)));
+
+		pack.flush();
+		return;
+	}
+
 	uint line(0);
 	const auto pfx([&chan,&stats,&line]
 	(Locutor &out) -> Locutor &
@@ -1600,10 +1830,55 @@ void ResPublica::vote_stats_user(Locutor &out,
                                  const std::string &user,
                                  const Tokens &toks)
 {
+	using namespace colors;
+
+	std::vector<std::string> keys
+	{{
+		"CHANNELS",
+		"SPEAKER",
+		"BALLOTS",
+		"YEA BALLOTS",
+		"NAY BALLOTS",
+		"WINNING",
+		"LOSING",
+	}};
+
+	std::map<std::string, size_t> stats;
+	std::set<uint> channels;
+	for(const auto &p : vdb.get_positions(user))
+	{
+		const auto &position(p.second);
+		const auto &outcome(vdb.get_outcome(p.first));
+		const bool yc(position.ballot == 'y');
+		const bool nc(position.ballot == 'n');
+		stats["YEA BALLOTS"] += yc;
+		stats["NAY BALLOTS"] += nc;
+		stats["BALLOTS"] += yc + nc;
+		stats["SPEAKER"] += position.speaker;
+		channels.emplace(outcome.chan);
 
+		if(outcome.passed && yc)
+			++stats["WINNING"];
+		else if(nc)
+			++stats["LOSING"];
+	}
 
-}
+	stats["CHANNELS"] = channels.size();
 
+	uint line(0);
+	const auto pfx([&user,&stats,&line]
+	(Locutor &out) -> Locutor &
+	{
+		out << user << " (" << (line++) << "/" << stats.size() << ")  ";
+		return out;
+	});
+
+	pfx(out) << "Statistics for user\n";
+	for(const auto &key : keys)
+		pfx(out) << BOLD << std::setw(12) << std::left << std::setfill(' ') << key << OFF << ": " << stats[key] << "\n";
+
+	out << flush;
+}
 
 
 void ResPublica::vote_stats_chan_user(Locutor &out,
@@ -1625,34 +1900,40 @@ void ResPublica::vote_stats_chan_user(Locutor &out,
 	}};
 
 	std::map<std::string, size_t> stats;
-	for(auto it(vdb.cbegin()); it != vdb.end(); ++it)
+	const auto &positions(vdb.get_positions(user));
+	const auto chan_id(vdb.chan_id(chan));
+	for(const auto &p : positions)
 	{
-		const auto &id(lex_cast<id_t>(it->first));
-		const Adoc doc(it->second);
-		if(doc["chan"] != chan)
+		const auto &position(p.second);
+		const auto &outcome(vdb.get_outcome(p.first));
+		if(outcome.chan != chan_id)
 			continue;
 
-		const Adoc yd(doc.get_child("yea",Adoc{}));
-		const Adoc nd(doc.get_child("nay",Adoc{}));
-		const auto yeas(yd.into<std::set<std::string>>());
-		const auto nays(nd.into<std::set<std::string>>());
-		const auto &yc(yeas.count(user));
-		const auto &nc(nays.count(user));
-		assert(yc + nc < 2);
+		const bool yc(position.ballot == 'y');
+		const bool nc(position.ballot == 'n');
 		stats["YEA BALLOTS"] += yc;
 		stats["NAY BALLOTS"] += nc;
 		stats["BALLOTS"] += yc + nc;
+		stats["SPEAKER"] += position.speaker;
 
-		if(doc["acct"] == user)
-			++stats["SPEAKER"];
-
-		const auto &reason(doc["reason"]);
-		if(reason.empty() && yc)
+		if(outcome.passed && yc)
 			++stats["WINNING"];
 		else if(nc)
 			++stats["LOSING"];
-		else
-			++stats["ABSTAIN"];
+	}
+
+	// Every other motion in the channel is one the user did not win or lose
+	stats["ABSTAIN"] = vdb.count(chan,{}) - stats["WINNING"] - stats["LOSING"];
+
+	if(packed(chan))
+	{
+		Packer pack(out);
+		pack(chan + " statistics for " + user);
+		for(const auto &key : keys)
+			pack(key,lex_cast(stats[key]));
+
+		pack.flush();
+		return;
 	}
 
 	uint line(0);
@@ -1671,6 +1952,30 @@ void ResPublica::vote_stats_chan_user(Locutor &out,
 }
 
 
+void ResPublica::vote_ballots(User &user,
+                              const Tokens &toks,
+                              const Ballot &ballot)
+{
+	std::vector<id_t> ids;
+	for(const auto &tok : toks)
+		ids.emplace_back(lex_cast<id_t>(*tok));
+
+	// Eligibility checks within the batch are answered by the census memo after the first
+	// per channel; effects applied with prejudice share MODE lines, and the acks share lines.
+	const Lictor::Batch batch(lictor);
+	Vote::Acks acks(user);
+	for(const auto &id : ids) try
+	{
+		auto &vote(voting.get(id));
+		vote.event_vote(user,ballot);
+	}
+	catch(const Exception &e)
+	{
+		acks.reject(id,string(e));
+	}
+}
+
+
 void ResPublica::vote_access(Locutor &out,
                              const Chan &chan,
                              const User &user,
@@ -1678,16 +1983,14 @@ void ResPublica::vote_access(Locutor &out,
 {
 	using namespace colors;
 
-	const Adoc ccfg(chan.get("config.vote"));
 	for(const auto &type : vote::names)
 	{
-		Adoc cfg(ccfg);
-		cfg.merge(ccfg.get_child(type,Adoc{}));
-		if(!cfg.get("enable",false))
+		const auto &cfg(confs.get_conf(chan,type));
+		if(!cfg.enable)
 			continue;
 
 		std::stringstream perm;
-		if(enfranchised(cfg,chan,user))
+		if(census.enfranchised(cfg,chan,user))
 			perm << "E";
 
 		if(speaker(cfg,chan,user))
@@ -1712,7 +2015,7 @@ void ResPublica::handle_delta(const Msg &msg,
 	if(user.is_myself())
 		return;
 
-	const auto cfg(chan.get("config.vote"));
+	const auto &cfg(confs.get(chan));
 
 	if(cfg.get("trial.enable",false))
 		delta_trial(msg,chan,user,delta);
@@ -1727,7 +2030,7 @@ void ResPublica::delta_appeal(const Msg &msg,
                               User &user,
                               const Delta &delta)
 {
-	const Adoc cfg(chan.get("config.vote.appeal"));
+	const Adoc cfg(confs.get(chan).get_child("appeal",Adoc{}));
 	const Deltas cfgdelts(cfg.get("deltas",std::string{}));
 	const auto match(std::any_of(cfgdelts.begin(),cfgdelts.end(),[&delta]
 	(const auto &cfgd)
@@ -1747,7 +2050,7 @@ void ResPublica::delta_trial(const Msg &msg,
                              User &user,
                              const Delta &delta)
 {
-	const Adoc cfg(chan.get("config.vote.trial"));
+	const Adoc cfg(confs.get(chan).get_child("trial",Adoc{}));
 	const Deltas cfgdelts(cfg.get("deltas",std::string{}));
 	const auto match(std::any_of(cfgdelts.begin(),cfgdelts.end(),[&delta]
 	(const auto &cfgd)
@@ -1770,7 +2073,7 @@ bool ResPublica::delta_trial_jeopardy(const Msg &msg,
                                       User &user,
                                       const Delta &delta)
 {
-	const Adoc cfg(chan.get("config.vote.trial"));
+	const Adoc cfg(confs.get(chan).get_child("trial",Adoc{}));
 	const auto limit_quorum(secs_cast(cfg.get("limit.quorum.jeopardy","4h")));
 	if(limit_quorum)
 	{
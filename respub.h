@@ -26,23 +26,39 @@ class ResPublica
 	Users &users;
 	Chans &chans;
 	Events &events;
+	Help help;
 	Vdb vdb;
 	Praetor praetor;
 	Voting voting;
 
+	struct Cursor
+	{
+		std::vector<std::string> toks;               // Query of the list, less any --after
+		id_t last;                                   // Last id listed
+		time_t when;                                 // Time of that page
+	};
+
+	static constexpr time_t CURSOR_TTL = 3600;       // Secs an unfinished list can be continued
+
+	// Last !vote list with more to show : acct, tolower(chan) => cursor; dropped at its end or TTL
+	std::map<std::pair<std::string, std::string>, Cursor> cursors;
+
 	bool delta_trial_jeopardy(const Msg &m, Chan &c, User &u, const Delta &d);
 	void delta_trial(const Msg &m, Chan &c, User &u, const Delta &d);
 	void delta_appeal(const Msg &m, Chan &c, User &u, const Delta &d);
 	void handle_delta(const Msg &m, Chan &c, User &u, const Delta &d);
 	void vote_access(Locutor &out, const Chan &c, const User &u, const Tokens &t);
+	void vote_ballots(User &u, const Tokens &t, const Ballot &b);
 	void vote_stats_chan_user(Locutor &out, const std::string &chan, const std::string &user, const Tokens &t);
 	void vote_stats_user(Locutor &out, const std::string &user, const Tokens &t);
 	void vote_stats_chan(Locutor &out, const std::string &chan, const Tokens &t);
 	void opinion(const Chan &c, const User &u, Locutor &out, const Tokens &t);
-	void vote_list_oneline(const Chan &c, const User &u, Locutor &out, const Vote &vote);
+	bool packed(const std::string &chan, const std::string &type = {});   // The channel prefers packed replies
+	void vote_info_packed(const User &u, Locutor &out, const VoteView &vote);
+	void vote_list_oneline(const Chan &c, const User &u, Locutor &out, const VoteView &vote);
 	void vote_list_oneline(const Chan &c, const User &u, Locutor &out, const std::list<id_t> &result);
-	void handle_vote_info(const Msg &m, const User &u, Locutor &out, const Tokens &t, const Vote &vote);
-	void handle_vote_list(const Msg &m, const User &u, Locutor &out, const Tokens &t, const Vote &vote);
+	void handle_vote_info(const Msg &m, const User &u, Locutor &out, const Tokens &t, const VoteView &vote);
+	void handle_vote_list(const Msg &m, const User &u, Locutor &out, const Tokens &t, const VoteView &vote);
 	void handle_vote_list(const Msg &m, const User &u, Locutor &out, const Tokens &t, const id_t &id);
 	void handle_vote_list(const Msg &m, const Chan &c, const User &u, Locutor &out, const Tokens &t);
 	void handle_help(const Msg &m, Locutor &out, const Tokens &t);
@@ -71,6 +87,7 @@ class ResPublica
 	void handle_vote_list(const Msg &m, Chan &c, User &u, const Tokens &t, const id_t &id);
 	void handle_vote_list(const Msg &m, Chan &c, User &u, const Tokens &t);
 	void handle_vote_ballot(const Msg &m, Chan &c, User &u, const Tokens &t, const Ballot &b);
+	void handle_vote_strike(const Msg &m, Chan &c, User &u, const Tokens &t);
 	void handle_vote_cancel(const Msg &m, Chan &c, User &u, const Tokens &t);
 	void handle_vote_id(const Msg &m, Chan &c, User &u, const Tokens &t);
 	void handle_vote(const Msg &m, Chan &c, User &u, Tokens t);
@@ -92,6 +109,11 @@ class ResPublica
 	void handle_privmsg(const Msg &m, Chan &c, User &u);
 
   public:
-	ResPublica(Bot &bot);
+	static constexpr uint HANDOFF_VERSION = 2;       // Bumped when the handoff document changes
+
+	static Adoc adopt(const std::string &handoff);   // The handed state when it is this version, else empty
+	std::string handoff() const;                     // State for the next module across a reload
+
+	ResPublica(Bot &bot, const Adoc &handoff = {});
 	~ResPublica() noexcept;
 };
@@ -19,6 +19,9 @@ std::mutex mutex;
 std::condition_variable cond;
 bool hangup, interrupt;
 
+// State an outgoing respub.so leaves for the next one across a reload
+std::string handoff;
+
 
 static
 void handle_hup()
@@ -78,6 +81,8 @@ int main(int argc, char **argv) try
 	opts["user"] = "SPQF";
 	opts["gecos"] = "Senate & People of Freenode (#SPQF)";
 	opts["quit-msg"] = "Alea iacta est";
+	opts["services-burst"] = "4";            // ChanServ commands sent before pacing
+	opts["services-interval"] = "3";         // Seconds between paced ChanServ commands
 
 	// Parse command line
 	opts.parse({argv+1,argv+argc});
@@ -122,24 +127,30 @@ int main(int argc, char **argv) try
 				throw Assertive("dlclose() error: ") << dlerror();
 		});
 
-		using mod_call_t = void (*)(Bot *);
-		const auto module_init(reinterpret_cast<mod_call_t>(dlsym(module.get(),"module_init")));
+		// The entry points taking the handoff are named apart from the old ones, so a module built
+		// for the other prototype is rejected here rather than called through the wrong one.
+		using mod_call_t = void (*)(Bot *, std::string *);
+		if(dlsym(module.get(),"module_init"))
+			throw Assertive("respub.so is older than this spqf and takes no handoff; rebuild it");
+
+		dlerror();
+		const auto module_init(reinterpret_cast<mod_call_t>(dlsym(module.get(),"module_init_handoff")));
 		{
 			const auto err(dlerror());
 			if(!module_init || err)
 				throw Assertive("dlsym() error: ") << err;
 		}
 
-		const auto module_fini(reinterpret_cast<mod_call_t>(dlsym(module.get(),"module_fini")));
+		const auto module_fini(reinterpret_cast<mod_call_t>(dlsym(module.get(),"module_fini_handoff")));
 		{
 			const auto err(dlerror());
 			if(!module_fini || err)
 				throw Assertive("dlsym() error: ") << err;
 		}
 
-		module_init(bot.get());
+		module_init(bot.get(),&handoff);
 		wait_reload();
-		module_fini(bot.get());
+		module_fini(bot.get(),&handoff);
 	}
 	catch(const Assertive &e)
 	{
@@ -12,17 +12,207 @@ using namespace irc::bot;
 
 // SPQF
 #include "log.h"
+#include "confs.h"
 #include "vote.h"
 #include "votes.h"
 #include "vdb.h"
 
 
-Vdb::Vdb(const std::string &dir):
-Adb(dir)
+Vdb::Vdb(const std::string &dir,
+         const Adoc &handoff):
+Adb(dir),
+indexed(false),
+sched(dir + ".sched"),
+journal(dir + ".journal"),
+cfgs(dir + ".cfg")
 {
+	adopt(handoff);
 }
 
 
+Vdb::~Vdb()
+noexcept try
+{
+	flush();
+}
+catch(const std::exception &e)
+{
+	std::cerr << "[Vdb]: \033[1;31mFailed to flush " << pending() << " votes: " << e.what() << "\033[0m" << std::endl;
+}
+
+
+void Vdb::flush()
+{
+	for(auto it(dirty.begin()); it != dirty.end(); it = dirty.erase(it))
+		write(it->first,it->second);
+}
+
+
+void Vdb::flush(const id_t &id)
+{
+	const auto it(dirty.find(id));
+	if(it == dirty.end())
+		return;
+
+	write(it->first,it->second);
+	dirty.erase(it);
+}
+
+
+void Vdb::put(const id_t &id,
+              const Adoc &doc,
+              const size_t &from,
+              const size_t &to)
+{
+	if(indexed)
+		index(id,doc);
+
+	const auto it(dirty.find(id));
+	if(it == dirty.end())
+	{
+		dirty.emplace(id,Pending{doc,from,to});
+		return;
+	}
+
+	// Keep the first unfolded record: none of the journal is released until the doc is written
+	auto &pending(it->second);
+	pending.doc = doc;
+	pending.to = to;
+}
+
+
+void Vdb::write(const id_t &id,
+                const Pending &pending)
+{
+	Adb::set(lex_cast(id),pending.doc);
+	for(auto seq(pending.from); seq < pending.to; ++seq)
+		journal_del(id,seq);
+}
+
+
+void Vdb::cfg_put(const Snapshot &snap)
+{
+	if(stored.count(snap.hash))
+		return;
+
+	if(!cfgs.exists(snap.hash))
+		cfgs.set(snap.hash,snap.doc);
+
+	stored.emplace(snap.hash);
+}
+
+
+Snap Vdb::cfg_get(const std::string &hash)
+{
+	if(auto ret = snapshots.find(hash))
+		return ret;
+
+	const Adoc doc(cfgs.get(std::nothrow,hash));
+	if(doc.empty())
+		return {};
+
+	stored.emplace(hash);
+	return snapshots(doc);
+}
+
+
+void Vdb::journal_add(const id_t &id,
+                      const size_t &seq,
+                      const Adoc &record)
+{
+	journal.set(journal_key(id,seq),record);
+}
+
+
+void Vdb::journal_del(const id_t &id,
+                      const size_t &seq)
+{
+	journal.del(journal_key(id,seq));
+}
+
+
+Adoc Vdb::journal_get(const id_t &id,
+                      const size_t &seq)
+{
+	return journal.get(std::nothrow,journal_key(id,seq));
+}
+
+
+std::string Vdb::journal_key(const id_t &id,
+                             const size_t &seq)
+{
+	std::stringstream key;
+	key << std::setw(10) << std::setfill('0') << id
+	    << ":"
+	    << std::setw(10) << std::setfill('0') << seq;
+
+	return key.str();
+}
+
+
+void Vdb::sched_add(const id_t &id,
+                    const time_t &absolute)
+{
+	Adoc doc;
+	doc.put("id",id);
+	doc.put("absolute",absolute);
+	sched.set(sched_key(id,absolute),doc);
+}
+
+
+void Vdb::sched_del(const id_t &id,
+                    const time_t &absolute)
+{
+	sched.del(sched_key(id,absolute));
+}
+
+
+Vdb::Expiries Vdb::sched_page(const size_t &limit)
+{
+	Expiries ret;
+	for(auto it(sched.cbegin()); it != sched.cend() && ret.size() < limit; ++it)
+	{
+		// Keys are fixed-width so the lexical order of the db is the order of expiration;
+		// anything not starting with a digit is bookkeeping and sorts after every entry.
+		const auto &key(it->first);
+		if(key.empty() || !isdigit(key.front()))
+			break;
+
+		const auto absolute(lex_cast<time_t>(key.substr(0,20)));
+		const auto id(lex_cast<id_t>(key.substr(21)));
+		ret.emplace_back(std::make_tuple(id,absolute));
+	}
+
+	return ret;
+}
+
+
+void Vdb::sched_set_migrated()
+{
+	Adoc doc;
+	doc.put("time",time(nullptr));
+	sched.set(SCHED_MIGRATED,doc);
+}
+
+
+std::string Vdb::sched_key(const id_t &id,
+                           const time_t &absolute)
+{
+	std::stringstream key;
+	key << std::setw(20) << std::setfill('0') << std::max(absolute,time_t(0))
+	    << ":"
+	    << std::setw(10) << std::setfill('0') << id;
+
+	return key.str();
+}
+
+
+decltype(Vdb::SCHED_MIGRATED) Vdb::SCHED_MIGRATED
+{
+	"migrated"
+};
+
+
 const std::vector<std::string> Vdb::operators
 {{
 	"",     // empty operator checks if key exists (and is non-empty)
@@ -36,11 +226,334 @@ const std::vector<std::string> Vdb::operators
 }};
 
 
+size_t Vdb::count(const std::string &chan,
+                  const Terms &terms)
+{
+	const auto &ids(get_index(chan,terms));
+	const auto type(typed(terms));
+	const auto covered(std::all_of(terms.begin(),terms.end(),[&chan,&type]
+	(const Term &term)
+	{
+		const auto &val(std::get<2>(term));
+		return indexes(term) && boost::iequals(val,std::get<0>(term) == "chan"? chan : std::get<2>(*type));
+	}));
+
+	if(covered)
+		return ids.size();
+
+	return std::count_if(ids.begin(),ids.end(),[this,&terms]
+	(const id_t &id)
+	{
+		const Adoc doc(get_doc(id));
+		return std::all_of(terms.begin(),terms.end(),[&doc]
+		(const auto &term)
+		{
+			return match(doc,term);
+		});
+	});
+}
+
+
+Vdb::Results Vdb::query(const std::string &chan,
+                        const Terms &terms,
+                        const size_t &limit,
+                        const id_t &after,
+                        const bool &descending)
+{
+	Results ret;
+	const auto &ids(get_index(chan,terms));
+	const auto matched([this,&terms,&limit,&ret]
+	(const id_t &id)
+	{
+		const Adoc doc(get_doc(id));
+		if(std::all_of(terms.begin(),terms.end(),[&doc](const auto &term) { return match(doc,term); }))
+			ret.emplace_back(id);
+
+		return !limit || ret.size() < limit;
+	});
+
+	if(descending)
+	{
+		auto it(after? std::set<id_t>::const_reverse_iterator(ids.lower_bound(after)) : ids.crbegin());
+		for(; it != ids.crend() && matched(*it); ++it);
+	}
+	else
+	{
+		auto it(ids.upper_bound(after));
+		for(; it != ids.cend() && matched(*it); ++it);
+	}
+
+	return ret;
+}
+
+
+uint Vdb::chan_id(const std::string &chan)
+const
+{
+	return chans.find(index_key(chan));
+}
+
+
+const Vdb::Outcome &Vdb::get_outcome(const id_t &id)
+{
+	if(!indexed)
+		index();
+
+	const auto it(outcomes.find(id));
+	if(it == outcomes.end())
+		throw Exception("Could not find a vote by that ID.");
+
+	return it->second;
+}
+
+
+const Vdb::Opinions &Vdb::get_opinions(const std::string &chan,
+                                        const time_t &since)
+{
+	static const Opinions empty;
+
+	if(!indexed)
+		index();
+
+	const auto it(opinions.find(index_key(chan)));
+	if(it == opinions.end())
+		return empty;
+
+	auto &latest(it->second);
+	for(auto vit(latest.begin()); vit != latest.end();)
+		vit = vit->second.get_ended() <= since? latest.erase(vit) : std::next(vit);
+
+	return latest;
+}
+
+
+const Vdb::Positions &Vdb::get_positions(const std::string &acct)
+{
+	static const Positions empty;
+
+	if(!indexed)
+		index();
+
+	const auto it(acctidx.find(tolower(acct)));
+	return it != acctidx.end()? it->second : empty;
+}
+
+
+Adoc Vdb::get_doc(const id_t &id)
+{
+	const auto it(dirty.find(id));
+	if(it != dirty.end())
+		return it->second.doc;
+
+	return Adb::get(std::nothrow,lex_cast(id));
+}
+
+
+Adoc Vdb::handoff()
+const
+{
+	Adoc ret;
+	if(!indexed)
+		return ret;
+
+	// Keys may contain the '.' path separator, so entries are listed rather than keyed
+	Adoc idx;
+	for(const auto &p : chanidx)
+	{
+		std::stringstream ids;
+		for(const auto &id : p.second)
+			ids << id << " ";
+
+		Adoc doc;
+		doc.put("key",p.first);
+		doc.put("ids",ids.str());
+		idx.push_back({"",doc});
+	}
+
+	std::stringstream failed;
+	for(const auto &p : outcomes)
+		if(!p.second.passed)
+			failed << p.first << " ";
+
+	Adoc accts;
+	for(const auto &p : acctidx)
+	{
+		std::stringstream positions;
+		positions << p.first;
+		for(const auto &pos : p.second)
+		{
+			positions << " " << pos.first << (pos.second.speaker? "s" : "");
+			if(pos.second.ballot)
+				positions << pos.second.ballot;
+		}
+
+		accts.push(positions.str());
+	}
+
+	std::stringstream latest;
+	for(const auto &p : opinions)
+		for(const auto &o : p.second)
+			latest << o.first << " ";
+
+	ret.put_child("chans",idx);
+	ret.put("failed",failed.str());
+	ret.put_child("accts",accts);
+	ret.put("opinions",latest.str());
+	return ret;
+}
+
+
+void Vdb::adopt(const Adoc &handoff)
+try
+{
+	if(handoff.empty())
+		return;
+
+	for(const auto &p : handoff.get_child("chans",Adoc{}))
+	{
+		const auto key(p.second["key"]);
+		auto &ids(chanidx[key]);
+		for(const auto &id : tokens(p.second["ids"]))
+			ids.emplace_hint(ids.end(),lex_cast<id_t>(id));
+
+		// Every vote is under its channel alone as well as under the channel and type
+		if(key.find(' ') == std::string::npos)
+			for(const auto &id : ids)
+				outcomes[id] = { chans(key), true };
+	}
+
+	for(const auto &id : tokens(handoff["failed"]))
+		outcomes.at(lex_cast<id_t>(id)).passed = false;
+
+	for(const auto &p : handoff.get_child("accts",Adoc{}))
+	{
+		const auto toks(tokens(p.second.get("",std::string{})));
+		auto &positions(acctidx[toks.at(0)]);
+		for(auto it(toks.begin() + 1); it != toks.end(); ++it)
+		{
+			const auto end(it->find_first_not_of("0123456789"));
+			const auto flags(end != std::string::npos? it->substr(end) : std::string{});
+			auto &pos(positions[lex_cast<id_t>(it->substr(0,end))]);
+			pos.speaker = flags.find('s') != std::string::npos;
+			pos.ballot = flags.find('y') != std::string::npos? 'y':
+			             flags.find('n') != std::string::npos? 'n': 0;
+		}
+	}
+
+	// The few views of the latest opinions are read again rather than handed across
+	for(const auto &tok : tokens(handoff["opinions"]))
+	{
+		const auto id(lex_cast<id_t>(tok));
+		const Adoc doc(get_doc(id));
+		opinions[index_key(doc["chan"])].emplace(id,VoteView(doc,*this));
+	}
+
+	indexed = true;
+}
+catch(const std::exception &e)
+{
+	chanidx.clear();
+	outcomes.clear();
+	acctidx.clear();
+	opinions.clear();
+	std::cerr << "[Vdb]: \033[1;31mFailed to adopt the indexes; they will be read again: " << e.what() << "\033[0m" << std::endl;
+}
+
+
+void Vdb::index()
+{
+	flush();
+	for(auto it(cbegin(stldb::SNAPSHOT)); it != cend(); ++it)
+		index(lex_cast<id_t>(it->first),Adoc(it->second));
+
+	indexed = true;
+}
+
+
+void Vdb::index(const id_t &id,
+                const Adoc &doc)
+{
+	const auto chan(index_key(doc["chan"]));
+	chanidx[chan].emplace(id);
+	chanidx[index_key(doc["chan"],doc["type"])].emplace(id);
+	outcomes[id] = { chans(chan), doc["reason"].empty() };
+
+	// Ballots are only ever changed, never retracted, so positions are only overwritten
+	acctidx[tolower(doc["acct"])][id].speaker = true;
+
+	const Adoc yea(doc.get_child("yea",Adoc{}));
+	for(const auto &p : yea)
+		acctidx[tolower(p.second.get("",std::string{}))][id].ballot = 'y';
+
+	const Adoc nay(doc.get_child("nay",Adoc{}));
+	for(const auto &p : nay)
+		acctidx[tolower(p.second.get("",std::string{}))][id].ballot = 'n';
+
+	if(doc["type"] != "opine" || !secs_cast(doc["ended"]) || !doc["reason"].empty())
+		return;
+
+	auto &latest(opinions[chan]);
+	latest.erase(id);
+	try
+	{
+		latest.emplace(id,VoteView(doc,*this));
+	}
+	catch(const std::exception &e)
+	{
+		std::cerr << "[Vdb]: \033[1;31mNot indexing opinion #" << id << ": " << e.what() << "\033[0m" << std::endl;
+	}
+
+	while(latest.size() > OPINIONS)
+		latest.erase(latest.begin());
+}
+
+
+const std::set<id_t> &Vdb::get_index(const std::string &chan,
+                                     const Terms &terms)
+{
+	static const std::set<id_t> empty;
+
+	if(!indexed)
+		index();
+
+	const auto type(typed(terms));
+	const auto it(chanidx.find(type? index_key(chan,std::get<2>(*type)) : index_key(chan)));
+	return it != chanidx.end()? it->second : empty;
+}
+
+
+const Vdb::Term *Vdb::typed(const Terms &terms)
+{
+	const auto it(std::find_if(terms.begin(),terms.end(),[](const Term &term)
+	{
+		return std::get<0>(term) == "type" && indexes(term);
+	}));
+
+	return it != terms.end()? &(*it) : nullptr;
+}
+
+
+bool Vdb::indexes(const Term &term)
+{
+	const auto &key(std::get<0>(term));
+	const auto &op(std::get<1>(term));
+	return (key == "chan" || key == "type") && (op == "=" || op == "==");
+}
+
+
+std::string Vdb::index_key(const std::string &chan,
+                           const std::string &type)
+{
+	return type.empty()? tolower(chan) : tolower(chan) + " " + tolower(type);
+}
+
+
 Vdb::Results Vdb::query(const Terms &terms,
                         const size_t &limit,
                         const bool &descending)
 {
 	Results ret;
+	flush();
 
 	// TODO: Until stldb reverse iterators and propert sorting are fixed hack this for now...
 	query(terms,0,cbegin(),cend(),ret);
@@ -104,13 +617,32 @@ std::string Vdb::get_type(const id_t &id)
 std::string Vdb::get_value(const id_t &id,
                            const std::string &key)
 {
+	const auto it(dirty.find(id));
+	if(it != dirty.end())
+		return it->second.doc[key];
+
 	return Adb::get(std::nothrow,lex_cast(id))[key];
 }
 
 
+VoteView Vdb::view(const id_t &id)
+{
+	const auto it(dirty.find(id));
+	if(it != dirty.end())
+		return {it->second.doc,*this};
+
+	const Adoc doc(Adb::get(std::nothrow,lex_cast(id)));
+	if(doc.empty())
+		throw Exception("Could not find a vote by that ID.");
+
+	return {doc,*this};
+}
+
+
 std::unique_ptr<Vote> Vdb::get(const id_t &id)
 try
 {
+	flush(id);
 	switch(hash(get_type(id)))
 	{
 		case hash("config"):    return std::make_unique<vote::Config>(id,*this);
@@ -136,6 +668,7 @@ try
 		case hash("devoice"):   return std::make_unique<vote::DeVoice>(id,*this);
 		case hash("flags"):     return std::make_unique<vote::Flags>(id,*this);
 		case hash("civis"):     return std::make_unique<vote::Civis>(id,*this);
+		case hash("cives"):     return std::make_unique<vote::Cives>(id,*this);
 		case hash("censure"):   return std::make_unique<vote::Censure>(id,*this);
 		case hash("import"):    return std::make_unique<vote::Import>(id,*this);
 		default:                return std::make_unique<Vote>("",id,*this);
@@ -153,5 +686,5 @@ catch(const Exception &e)
 bool Vdb::exists(const id_t &id)
 const
 {
-	return Adb::exists(lex_cast(id));
+	return dirty.count(id) || Adb::exists(lex_cast(id));
 }
@@ -11,11 +11,14 @@ struct Vdb : Adb
 	using Term = std::tuple<std::string,std::string,std::string>;
 	using Terms = std::forward_list<Term>;
 	using Results = std::list<id_t>;
+	using Expiry = std::tuple<id_t,time_t>;
+	using Expiries = std::deque<Expiry>;
 
 	static const std::vector<std::string> operators;
 
 	bool exists(const id_t &id) const;
 	std::unique_ptr<Vote> get(const id_t &id);
+	VoteView view(const id_t &id);              // Decodes the record without constructing the Vote
 	std::string get_value(const id_t &id, const std::string &key);
 	std::string get_type(const id_t &id);
 
@@ -26,7 +29,112 @@ struct Vdb : Adb
   public:
 	Results query(const Terms &terms, const size_t &limit = 0, const bool &descending = true);
 
-	Vdb(const std::string &dir);
+	struct Outcome
+	{
+		uint chan;                              // tolower(chan) interned in chans
+		bool passed;                            // No reason; an open vote has none either
+	};
+
+	struct Position
+	{
+		bool speaker;                           // Made the motion
+		char ballot;                            // 'y', 'n' or 0 if none was cast
+	};
+
+	using Positions = std::map<id_t, Position>;
+	using Opinions = std::map<id_t, VoteView>;
+
+  private:
+	static constexpr size_t OPINIONS = 3;       // Latest passed opine votes kept for each channel, as !opinion shows
+
+	bool indexed;                               // The indexes have been read from the db
+	Interned chans;                             // Channel names of outcomes, apart from the ballot names
+	std::map<std::string, std::set<id_t>> chanidx;   // Votes : tolower(chan) and tolower(chan) + " " + type => ids
+	std::unordered_map<id_t, Outcome> outcomes;            // Votes : id => outcome
+	std::unordered_map<std::string, Positions> acctidx;    // Accounts : tolower(acct) => votes spoken or cast on
+	std::unordered_map<std::string, Opinions> opinions;    // Latest passed opine votes : tolower(chan) => views
+
+	static std::string index_key(const std::string &chan, const std::string &type = {});
+	static bool indexes(const Term &term);      // An equality on chan or type
+	static const Term *typed(const Terms &terms);   // The type term selecting an index, or null
+	const std::set<id_t> &get_index(const std::string &chan, const Terms &terms);
+	void index(const id_t &id, const Adoc &doc);
+	void index();                               // Reads every vote once per load; put() keeps them current
+	void adopt(const Adoc &handoff);            // Indexes of the previous module instead of reading every vote
+	Adoc get_doc(const id_t &id);
+
+  public:
+	using Adb::count;
+
+	const Opinions &get_opinions(const std::string &chan, const time_t &since);  // Drops any which ended before since
+	const Positions &get_positions(const std::string &acct);
+	const Outcome &get_outcome(const id_t &id);
+	uint chan_id(const std::string &chan) const;    // Interned::NONE when no vote was held there
+
+	// The votes of a channel in id order; after is an exclusive cursor (0 to start at an end)
+	Results query(const std::string &chan, const Terms &terms, const size_t &limit, const id_t &after = 0, const bool &descending = true);
+	size_t count(const std::string &chan, const Terms &terms);      // From the index size when it can be
+	Adoc handoff() const;                       // Indexes for the next module; empty until indexed
+
+  private:
+	static const std::string SCHED_MIGRATED;
+
+	Adb sched;                                  // Pending expirations : "absolute:id" => {}
+
+	static std::string sched_key(const id_t &id, const time_t &absolute);
+
+  public:
+	bool sched_migrated() const                 { return sched.exists(SCHED_MIGRATED);              }
+	void sched_set_migrated();
+
+	Expiries sched_page(const size_t &limit);   // Earliest pending expirations, ascending
+	void sched_del(const id_t &id, const time_t &absolute);
+	void sched_add(const id_t &id, const time_t &absolute);
+
+  private:
+	Adb journal;                                // Ballots since a vote's last save : "id:seq" => record
+
+	static std::string journal_key(const id_t &id, const size_t &seq);
+
+  public:
+	Adoc journal_get(const id_t &id, const size_t &seq);        // Empty when there is no record
+	void journal_del(const id_t &id, const size_t &seq);
+	void journal_add(const id_t &id, const size_t &seq, const Adoc &record);
+
+  private:
+	Adb cfgs;                                   // Vote configuration snapshots : hash => cfg
+	std::set<std::string> stored;               // Hashes known to be in cfgs
+
+  public:
+	Snap cfg_get(const std::string &hash);      // Interned; null when there is no such config
+	void cfg_put(const Snapshot &snap);         // Stores the config once
+
+  private:
+	// Vote documents are written behind: put() keeps the latest document of
+	// each vote and flush() writes them out one vote at a time. Each vote's
+	// document is written before the journal records it folds are deleted,
+	// so a crash between two votes loses nothing, but a flush is not one
+	// atomic write. The dirty map has no lock of its own; callers must hold
+	// the Bot lock.
+	struct Pending
+	{
+		Adoc doc;                               // Latest state of the vote
+		size_t from;                            // Journal records folded into the doc once written
+		size_t to;
+	};
+
+	std::map<id_t,Pending> dirty;               // Vote documents written behind
+
+	void write(const id_t &id, const Pending &pending);
+
+  public:
+	size_t pending() const                      { return dirty.size();                              }
+	void put(const id_t &id, const Adoc &doc, const size_t &from, const size_t &to);
+	void flush(const id_t &id);                 // Durability barrier for one vote
+	void flush();                               // Writes every dirty vote
+
+	Vdb(const std::string &dir, const Adoc &handoff = {});
+	~Vdb() noexcept;
 };
 
 
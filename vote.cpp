@@ -12,59 +12,318 @@ using namespace irc::bot;
 
 // SPQF
 #include "log.h"
+#include "praeco.h"
+#include "confs.h"
 #include "vote.h"
+#include "census.h"
+#include "vdb.h"
 
 
+decltype(interned) interned;
+
 decltype(ystr) ystr                              { "yea", "yes", "yea", "Y", "y"                   };
 decltype(nstr) nstr                              { "nay", "no", "N", "n"                           };
 
 decltype(Vote::ARG_KEYED) Vote::ARG_KEYED        { "--"                                            };
 decltype(Vote::ARG_VALUED) Vote::ARG_VALUED      { "="                                             };
+decltype(Vote::acks) Vote::acks                  { nullptr                                         };
+
+
+// Applies a journaled ballot to the ballots of a vote as cast() did
+template<class Names>
+static
+void replay(const Adoc &record,
+            Names &yea,
+            Names &nay,
+            Names &veto,
+            Names &hosts)
+{
+	const auto acct(record["acct"]);
+	switch(::ballot(record["ballot"]))
+	{
+		case Ballot::YEA:
+			yea.emplace(acct);
+			nay.erase(acct);
+			break;
+
+		case Ballot::NAY:
+			nay.emplace(acct);
+			yea.erase(acct);
+			break;
+	}
+
+	if(record.get("veto",false))
+		veto.emplace(acct);
+
+	const auto host(record["host"]);
+	if(!host.empty())
+		hosts.emplace(host);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// VoteView
+//
+
+
+VoteView::VoteView(const Vote &vote):
+id(vote.get_id()),
+type(vote.get_type()),
+chan(vote.get_chan_name()),
+acct(vote.get_user_acct()),
+issue(vote.get_issue()),
+cfg(vote.get_snap()),
+began(vote.get_began()),
+ended(vote.get_ended()),
+expiry(vote.get_expiry()),
+quorum(vote.get_quorum()),
+reason(vote.get_reason()),
+effect(vote.get_effect()),
+yea(vote.get_yea().names()),
+nay(vote.get_nay().names()),
+veto(vote.get_veto().names()),
+hosts(vote.get_hosts().names())
+{
+}
+
+
+VoteView::VoteView(const Adoc &doc,
+                   Vdb &vdb)
+try:
+id(doc.get<id_t>("id")),
+type(doc["type"]),
+chan(doc["chan"]),
+acct(tolower(doc["acct"])),
+issue(doc["issue"]),
+cfg([&]
+{
+	if(!doc.has("cfg_hash"))                                 // Stored before configs were shared
+		return snapshots(doc.get_child("cfg",Adoc{}));
+
+	return snapshots(vdb.cfg_get(doc["cfg_hash"]),doc.get_child("cfg_delta",Adoc{}));
+}()),
+began(secs_cast(doc["began"])),
+ended(secs_cast(doc["ended"])),
+expiry(secs_cast(doc["expiry"])),
+quorum(doc.get("quorum",0U)),
+reason(doc["reason"]),
+effect(doc["effect"]),
+yea(doc.get_child("yea",Adoc{}).into<decltype(yea)>()),
+nay(doc.get_child("nay",Adoc{}).into<decltype(nay)>()),
+veto(doc.get_child("veto",Adoc{}).into<decltype(veto)>()),
+hosts(doc.get_child("hosts",Adoc{}).into<decltype(hosts)>())
+{
+	if(!cfg || cfg->doc.empty())
+		throw Assertive("The configuration for this vote is missing and required.");
+
+	// An open vote's ballots since its last save are in the journal, as for the Vote itself
+	for(auto seq(doc.get<size_t>("journal",0)); !ended; ++seq)
+	{
+		const Adoc record(vdb.journal_get(id,seq));
+		if(record.empty())
+			break;
+
+		replay(record,yea,nay,veto,hosts);
+	}
+}
+catch(const std::exception &e)
+{
+	throw Assertive("Failed to read Vote data: ") << e.what();
+}
+
+
+bool VoteView::voted(const User &user)
+const
+{
+	return yea.count(user.get_acct()) || nay.count(user.get_acct()) || hosts.count(user.get_host());
+}
+
+
+Ballot VoteView::position(const User &user)
+const
+{
+	const auto &acct(user.get_acct());
+	return yea.count(acct)? Ballot::YEA:
+	       nay.count(acct)? Ballot::NAY:
+	                        throw Exception("No position taken.");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Vote::Acks
+//
+
+
+Vote::Acks::Acks(User &user):
+user(user),
+outer(Vote::acks)
+{
+	Vote::acks = this;
+}
+
+
+Vote::Acks::~Acks()
+noexcept try
+{
+	Vote::acks = outer;
+
+	const auto &nick(user.get_nick());
+	for(const auto &p : chan_acks)
+		praeco(Praeco::ACK,p.first,[chan(p.first),nick,acks(p.second)]
+		{
+			auto &c(get_chans().get(chan));
+			c << get_users().get(nick);
+			list(c,acks);
+			c << c.flush;
+		});
+
+	for(const auto &p : chan_rejs)
+		praeco(Praeco::ACK,p.first,[chan(p.first),nick,rejs(p.second)]
+		{
+			auto &c(get_chans().get(chan));
+			c << get_users().get(nick);
+			list(c,rejs);
+			c << c.flush;
+		});
+
+	if(priv_acks.empty() && priv_rejs.empty())
+		return;
+
+	praeco(Praeco::ACK,nick,[nick,acks(priv_acks),rejs(priv_rejs)]
+	{
+		auto &u(get_users().get(nick));
+		if(!acks.empty())
+			list(u,acks);
+
+		if(!rejs.empty())
+			list(u,rejs);
+
+		u << u.flush;
+	});
+}
+catch(const std::exception &e)
+{
+	std::cerr << "[Vote::Acks]: \033[1;31m" << e.what() << "\033[0m" << std::endl;
+}
+
+
+void Vote::Acks::reject(const id_t &id,
+                        const std::string &reason)
+{
+	priv_rejs.emplace_back(id,reason);
+}
+
+
+void Vote::Acks::reject(const Vote &vote,
+                        const std::string &reason)
+{
+	const auto &cfg(vote.get_conf());
+	if(cfg.ballot.rej.chan)
+		chan_rejs[vote.get_chan_name()].emplace_back(vote.get_id(),reason);
+
+	if(cfg.ballot.rej.priv)
+		priv_rejs.emplace_back(vote.get_id(),reason);
+}
+
+
+void Vote::Acks::accept(const Vote &vote,
+                        const Stat &stat)
+{
+	const auto &cfg(vote.get_conf());
+	if(cfg.ballot.ack.chan)
+		chan_acks[vote.get_chan_name()].emplace_back(vote.get_id(),stat);
+
+	if(cfg.ballot.ack.priv)
+		priv_acks.emplace_back(vote.get_id(),stat);
+}
+
+
+void Vote::Acks::list(Locutor &out,
+                      const Rejected &rejs)
+{
+	using namespace colors;
+
+	out << "Your vote was not accepted for";
+	for(const auto &p : rejs)
+		out << " #" << BOLD << p.first << OFF << " (" << p.second << ")";
+
+	out << ".";
+}
+
+
+void Vote::Acks::list(Locutor &out,
+                      const Accepted &acks)
+{
+	using namespace colors;
+
+	for(const auto &stat : {Stat::ADDED, Stat::CHANGED})
+	{
+		const auto listed([&stat](const auto &p) { return p.second == stat; });
+		if(std::none_of(acks.begin(),acks.end(),listed))
+			continue;
+
+		out << (stat == Stat::CHANGED? "You have changed your vote on" : "Thanks for casting your vote on");
+		for(const auto &p : acks)
+			if(listed(p))
+				out << " #" << BOLD << p.first << OFF;
+
+		out << "! ";
+	}
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Vote
+//
 
 
 Vote::Vote(const std::string &type,
            const id_t &id,
-           Adb &adb,
+           Vdb &vdb,
            Chan &chan,
            User &user,
            const std::string &issue,
            const Adoc &cfg):
-Acct(&this->id,&adb),
+Acct(&this->id,&vdb),
+vdb(vdb),
 id(lex_cast(id)),
 type(type),
 chan(chan.get_name()),
 nick(user.get_nick()),
 acct(user.get_acct()),
 issue(strip_args(issue,ARG_KEYED)),
-cfg([&]
+base(confs.get_snap(chan,type)),                         // Defaults, saved config and type overrides
+delta([&]
 {
-	// Default config
-	Adoc ret;
-	ret.put("for",3600);
-	ret.put("duration",30);
-
-	ret.merge(chan.get("config.vote"));                      // Overwrite defaults with saved config
-	chan.set("config.vote",ret);                             // Write back combined result to db
-	ret.merge(ret.get_child(type,Adoc{}));                   // Import type-specifc overrides up to main
-
 	// Parse and validate any vote-time "audibles" from user.
 	const Adoc auds(Adoc::arg_ctor,issue,ARG_KEYED,ARG_VALUED);
-	const Adoc val_auds(ret.get_child("audibles",Adoc{}));
-	const auto val_auds_set(val_auds.into<std::set<std::string>>());
+	const auto &val_auds_set(base->conf.audibles);
 	auds.for_each([&val_auds_set](const auto &key, const auto &val)
 	{
 		if(!val_auds_set.count(key))
 			throw Exception("You cannot specify that option at vote-time.");
 	});
 
-	ret.merge(auds);
+	Adoc ret(auds);
 	ret.merge(cfg);                                          // Any overrides trumping all.
 	return ret;
 }()),
+cfg(snapshots(base,delta)),
 began(0),
 ended(0),
 expiry(0),
-quorum(0)
+quorum(0),
+folded(0),
+journaled(0),
+ack_since(0),
+ack_count(0),
+ack_held(0)
 {
 	if(!enabled())
 		throw Exception("Votes of this type are disabled by the configuration.");
@@ -73,29 +332,56 @@ quorum(0)
 
 Vote::Vote(const std::string &type,
            const id_t &id,
-           Adb &adb)
+           Vdb &vdb)
 try:
-Acct(&this->id,&adb),
+Acct(&this->id,&vdb),
+vdb(vdb),
 id(lex_cast(id)),
 type(get_val("type")),
 chan(get_val("chan")),
 nick(get_val("nick")),
 acct(tolower(get_val("acct"))),
 issue(get_val("issue")),
-cfg(get("cfg")),
+base([this]
+{
+	if(has("cfg_hash"))
+		return this->vdb.cfg_get(get_val("cfg_hash"));
+
+	const Adoc whole(get("cfg"));                            // Stored before configs were shared
+	return whole.empty()? Snap{} : snapshots(whole);
+}()),
+delta(get("cfg_delta")),
+cfg(snapshots(base,delta)),
 began(secs_cast(get_val("began"))),
 ended(secs_cast(get_val("ended"))),
 expiry(secs_cast(get_val("expiry"))),
 quorum(has("quorum")? get_val<uint>("quorum") : 0),
 reason(get_val("reason")),
 effect(get_val("effect")),
-yea(get("yea").into<decltype(yea)>()),
-nay(get("nay").into<decltype(nay)>()),
-veto(get("veto").into<decltype(veto)>()),
-hosts(get("hosts").into<decltype(hosts)>())
+state(get("state")),
+yea(get("yea")),
+nay(get("nay")),
+veto(get("veto")),
+hosts(get("hosts")),
+folded(has("journal")? get_val<size_t>("journal") : 0),
+journaled(folded),
+ack_since(0),
+ack_count(0),
+ack_held(0)
 {
-	if(cfg.empty())
+	if(!cfg)
 		throw Assertive("The configuration for this vote is missing and required.");
+
+	// Ballots cast since the last save() of an open vote are replayed from the journal
+	while(!ended)
+	{
+		const Adoc record(vdb.journal_get(get_id(),journaled));
+		if(record.empty())
+			break;
+
+		replay(record,yea,nay,veto,hosts);
+		++journaled;
+	}
 }
 catch(const std::exception &e)
 {
@@ -106,12 +392,6 @@ catch(const std::exception &e)
 Vote::operator Adoc()
 const
 {
-	Adoc yea, nay, veto, hosts;
-	yea.push(this->yea.begin(),this->yea.end());
-	nay.push(this->nay.begin(),this->nay.end());
-	veto.push(this->veto.begin(),this->veto.end());
-	hosts.push(this->hosts.begin(),this->hosts.end());
-
 	Adoc doc;
 	doc.put("id",get_id());
 	doc.put("type",get_type());
@@ -125,16 +405,56 @@ const
 	doc.put("quorum",get_quorum());
 	doc.put("reason",get_reason());
 	doc.put("effect",get_effect());
-	doc.put_child("cfg",get_cfg());
-	doc.put_child("yea",yea);
-	doc.put_child("nay",nay);
-	doc.put_child("veto",veto);
-	doc.put_child("hosts",hosts);
+	doc.put_child("state",get_state());
+	doc.put("cfg_hash",base->hash);
+	doc.put_child("cfg_delta",delta);
+	doc.put_child("yea",Adoc(get_yea()));
+	doc.put_child("nay",Adoc(get_nay()));
+	doc.put_child("veto",Adoc(get_veto()));
+	doc.put_child("hosts",Adoc(get_hosts()));
+	doc.put("journal",journaled);
 
 	return doc;
 }
 
 
+void Vote::save()
+{
+	vdb.cfg_put(*base);
+	vdb.put(get_id(),*this,folded,journaled);
+	folded = journaled;
+}
+
+
+void Vote::announce_ballots(const bool &now)
+{
+	const auto &cfg(get_conf());
+	if(!ack_held || (!now && time(nullptr) - ack_since < cfg.ballot.aggregate.window))
+		return;
+
+	const auto held(ack_held);
+	ack_since = time(nullptr);
+	ack_count = 0;
+	ack_held = 0;
+
+	// The summary stands for every ack held, so it is cried as a result rather than shed as an ack;
+	// the tally is only shown once the motion itself would be.
+	const bool tally(cfg.visible.active && cfg.visible.motion <= total());
+	praeco(Praeco::RESULT,get_chan_name(),[vote(VoteView(*this)),held,tally]
+	{
+		using namespace colors;
+
+		auto &chan(get_chans().get(vote.get_chan_name()));
+		chan << BOLD << held << OFF << " new ballots on " << vote;
+		if(tally)
+			chan << " (" << BOLD << FG::GREEN << vote.tally().first << OFF << "v"
+			     << BOLD << FG::RED << vote.tally().second << OFF << ")";
+
+		chan << "." << chan.flush;
+	});
+}
+
+
 void Vote::expire()
 {
 	expired();
@@ -152,7 +472,7 @@ void Vote::cancel()
 		save();
 	});
 
-	const auto vis(cfg.get("visible.motion",1U));
+	const auto vis(get_conf().visible.motion);
 	if(vis && total() >= vis)
 		announce_canceled();
 
@@ -168,13 +488,17 @@ try
 {
 	using namespace colors;
 
-	const auto &cfg(get_cfg());
 	const auto &chan(get_chan());
 	const auto &user(get_user());
-	const auto speaker_ballot(cfg.get("speaker.ballot","y"));
+	const auto &speaker_ballot(get_conf().speaker.ballot);
+
+	// The census knows the channel's own rules; a vote-time override of them still reads the log
+	const auto &chan_cfg(confs.get(chan,get_type()));
+	if(!get_quorum() && get_cfg().get_child("enfranchise",Adoc{}) == chan_cfg.get_child("enfranchise",Adoc{}))
+		set_quorum(calc_quorum(get_conf(),get_conf().quorum.turnout > 0.0? census.turnout(chan,get_type(),get_conf()) : 0));
 
 	if(!get_quorum())
-		set_quorum(calc_quorum(cfg,chan));
+		set_quorum(calc_quorum(get_conf(),chan));
 
 	if(is_ballot(speaker_ballot))
 		cast(ballot(speaker_ballot),user);
@@ -183,7 +507,7 @@ try
 	set_began();
 	save();
 
-	if(cfg.get("visible.motion",1U) == 1U)
+	if(get_conf().visible.motion == 1U)
 		announce_starting();
 }
 catch(...)
@@ -200,8 +524,11 @@ try
 {
 	const scope s([this]
 	{
-		if(!std::current_exception())
-			save();
+		if(std::current_exception())
+			return;
+
+		save();
+		vdb.flush(get_id());       // The outcome is durable before the vote leaves the active set
 	});
 
 	if(!get_ended())
@@ -222,7 +549,7 @@ try
 	if(total() < get_quorum())
 	{
 		set_reason("quorum");
-		const auto vis(cfg.get("visible.motion",1U));
+		const auto vis(get_conf().visible.motion);
 		if(vis && total() >= vis)
 			announce_failed_quorum();
 
@@ -233,10 +560,10 @@ try
 		return;
 	}
 
-	if(yea.size() < calc_required(cfg,tally()))
+	if(yea.size() < calc_required(get_conf(),tally()))
 	{
 		set_reason("plurality");
-		const auto vis(cfg.get("visible.motion",1U));
+		const auto vis(get_conf().visible.motion);
 		if(vis && total() >= vis)
 			announce_failed_required();
 
@@ -247,19 +574,19 @@ try
 		return;
 	}
 
-	if(secs_cast(cfg["for"]) > 0)
+	if(get_conf().for_ > 0)
 	{
 		// Adjust the final "for" time value using the weighting system
-		const time_t min(secs_cast(cfg["for"]));
-		const time_t add(secs_cast(cfg["weight.yea"]) * this->yea.size());
-		const time_t sub(secs_cast(cfg["weight.nay"]) * this->nay.size());
+		const time_t min(get_conf().for_);
+		const time_t add(get_conf().weight.yea * this->yea.size());
+		const time_t sub(get_conf().weight.nay * this->nay.size());
 		const time_t val(min + add - sub);
-		cfg.put("for",val);
+		set_cfg("for",val);
 	}
 
 	set_reason("");
 
-	if(cfg.get("visible.motion",1U) > 0)
+	if(get_conf().visible.motion > 0)
 		announce_passed();
 
 	if(get_effect().empty())
@@ -275,11 +602,14 @@ catch(const std::exception &e)
 
 	save();
 
-	if(cfg.get("result.ack.chan",true))
-	{
-		auto &chan(get_chan());
-		chan << "The vote " << (*this) << " was rejected: " << e.what() << chan.flush;
-	}
+	if(get_conf().result.ack.chan)
+		praeco(Praeco::RESULT,get_chan_name(),[chan(get_chan_name()),id(get_id()),what(std::string(e.what()))]
+		{
+			using namespace colors;
+
+			auto &c(get_chans().get(chan));
+			c << "The vote " << "#" << BOLD << id << OFF << " was rejected: " << what << c.flush;
+		});
 }
 
 
@@ -287,27 +617,79 @@ void Vote::event_vote(User &user,
                       const Ballot &ballot)
 try
 {
-	const auto stat(cast(ballot,user));
+	const auto stat(accept(user,ballot));
 	announce_ballot_accept(user,stat);
+}
+catch(const Exception &e)
+{
+	announce_ballot_reject(user,string(e));
+}
 
+
+bool Vote::aggregated()
+{
+	const auto &agg(get_conf().ballot.aggregate);
+	if(!agg.threshold)
+		return false;
+
+	// Once a window reaches the threshold the acks are held until a summary is announced
+	const auto now(time(nullptr));
+	if(!ack_held && now - ack_since >= agg.window)
+	{
+		ack_since = now;
+		ack_count = 0;
+	}
+
+	if(++ack_count < agg.threshold && !ack_held)
+		return false;
+
+	++ack_held;
+	return true;
+}
+
+
+Stat Vote::accept(User &user,
+                  const Ballot &ballot)
+{
+	const auto stat(cast(ballot,user));
 	if(stat == Stat::ADDED)
 	{
 		hosts.emplace(user.get_host());
-		if(total() > 1 && cfg.get("visible.motion",1U) == total())
+		if(total() > 1 && get_conf().visible.motion == total())
 			announce_starting();
 	}
 
+	const bool had_effect(!get_effect().empty());
 	if(prejudiced() && get_effect().empty())
 		effective();
 
-	if(cfg.get("quorum.quick",false) && total() >= get_quorum() && yea.size() >= calc_required(cfg,tally()))
+	if(get_conf().quorum.quick && total() >= get_quorum() && yea.size() >= calc_required(get_conf(),tally()))
 		set_ended();
 
-	save();
+	// Only the ballot is journaled unless more of the vote has changed with it
+	if(get_ended() || had_effect != !get_effect().empty())
+		save();
+	else
+		journal(user,ballot,stat);
+
+	return stat;
 }
-catch(const Exception &e)
+
+
+void Vote::journal(const User &user,
+                   const Ballot &ballot,
+                   const Stat &stat)
 {
-	announce_ballot_reject(user,string(e));
+	const auto &acct(user.get_acct());
+
+	Adoc record;
+	record.put("acct",acct);
+	record.put("ballot",ballot == Ballot::YEA? "y" : "n");
+	record.put("veto",veto.count(acct) > 0);
+	record.put("host",stat == Stat::ADDED? user.get_host() : std::string{});
+	record.put("time",time(nullptr));
+	vdb.journal_add(get_id(),journaled,record);
+	++journaled;
 }
 
 
@@ -317,7 +699,6 @@ Stat Vote::cast(const Ballot &ballot,
 	if(get_ended())
 		throw Exception("Vote has already ended.");
 
-	const auto &cfg(get_cfg());
 	const auto &chan(get_chan());
 	const auto &began(get_began());
 	const auto &acct(user.get_acct());
@@ -327,24 +708,24 @@ Stat Vote::cast(const Ballot &ballot,
 		if(voted_host(user.get_host()) > 0)
 			throw Exception("You can not cast another vote from this hostname.");
 
-		if(!enfranchised(cfg,chan,user,began))
+		if(!census.enfranchised(get_conf(),chan,user,began))
 			throw Exception("You are not enfranchised for this vote.");
 
-		if(!qualified(cfg,chan,user,began))
+		if(!census.qualified(get_conf(),chan,user,began))
 			throw Exception("You have not been active enough qualify for this vote.");
 	}
 
-	if(ballot == Ballot::NAY && intercession(cfg,chan,user))
+	if(ballot == Ballot::NAY && intercession(get_conf(),chan,user))
 		veto.emplace(user.get_acct());
 
 	switch(ballot)
 	{
 		case Ballot::YEA:
-			return !yea.emplace(user.get_acct()).second?  throw Exception("You have already voted yea."):
+			return !yea.emplace(user.get_acct())?         throw Exception("You have already voted yea."):
 			       nay.erase(user.get_acct())?            Stat::CHANGED:
 			                                              Stat::ADDED;
 		case Ballot::NAY:
-			return !nay.emplace(user.get_acct()).second?  throw Exception("You have already voted nay."):
+			return !nay.emplace(user.get_acct())?         throw Exception("You have already voted nay."):
 			       yea.erase(user.get_acct())?            Stat::CHANGED:
 			                                              Stat::ADDED;
 		default:
@@ -355,154 +736,196 @@ Stat Vote::cast(const Ballot &ballot,
 
 void Vote::announce_starting()
 {
-	using namespace colors;
-
-	auto &chan(get_chan());
-	chan << "Vote " << (*this) << ": "
-	     << BOLD << get_type() << OFF << ": " << UNDER2 << get_issue() << OFF << ". "
-	     << "You have " << BOLD << secs_cast(secs_cast(cfg["duration"])) << OFF << " to vote; "
-	     << BOLD << get_quorum() << OFF << " votes are required for a quorum! ";
-
-	const auto &cfg(get_cfg());
-	if(cfg.get("quorum.prejudice",false))
-		chan << "Effects applied with prejudice. ";
-
-	const auto vreq(cfg.get("veto.quorum",0));
-	if(vreq > 1)
-		chan << vreq << " vetoes are required to annul. ";
-
-	chan << "Type or PM: "
-	     << BOLD << FG::GREEN << "!vote y" << OFF << " " << BOLD << get_id() << OFF
-	     << " or "
-	     << BOLD << FG::RED << "!vote n" << OFF << " " << BOLD << get_id() << OFF
-	     << chan.flush;
+	praeco(Praeco::RESULT,get_chan_name(),[vote(VoteView(*this))]
+	{
+		using namespace colors;
+
+		const auto &cfg(vote.get_conf());
+		auto &chan(get_chans().get(vote.get_chan_name()));
+		chan << "Vote " << vote << ": "
+		     << BOLD << vote.get_type() << OFF << ": " << UNDER2 << vote.get_issue() << OFF << ". "
+		     << "You have " << BOLD << secs_cast(cfg.duration) << OFF << " to vote; "
+		     << BOLD << vote.get_quorum() << OFF << " votes are required for a quorum! ";
+
+		if(cfg.quorum.prejudice)
+			chan << "Effects applied with prejudice. ";
+
+		const auto &vreq(cfg.veto.quorum);
+		if(vreq > 1)
+			chan << vreq << " vetoes are required to annul. ";
+
+		chan << "Type or PM: "
+		     << BOLD << FG::GREEN << "!vote y" << OFF << " " << BOLD << vote.get_id() << OFF
+		     << " or "
+		     << BOLD << FG::RED << "!vote n" << OFF << " " << BOLD << vote.get_id() << OFF
+		     << chan.flush;
+	});
 }
 
 
 void Vote::announce_passed()
 {
-	using namespace colors;
+	if(!get_conf().result.ack.chan)
+		return;
 
-	auto &chan(get_chan());
-	if(cfg.get("result.ack.chan",true))
+	praeco(Praeco::RESULT,get_chan_name(),[vote(VoteView(*this))]
 	{
-		chan << (*this) << ": "
-		     << BOLD << get_type() << OFF << ": "
-		     << UNDER2 << get_issue() << OFF << ". "
+		using namespace colors;
+
+		const auto &cfg(vote.get_conf());
+		auto &chan(get_chans().get(vote.get_chan_name()));
+		chan << vote << ": "
+		     << BOLD << vote.get_type() << OFF << ": "
+		     << UNDER2 << vote.get_issue() << OFF << ". "
 		     << FG::WHITE << BG::GREEN << BOLD << "The yeas have it." << OFF
-		     << " Yeas: " << FG::GREEN << BOLD << yea.size() << OFF << "."
-		     << " Nays: " << FG::RED << nay.size() << OFF << ".";
+		     << " Yeas: " << FG::GREEN << BOLD << vote.get_yea().size() << OFF << "."
+		     << " Nays: " << FG::RED << vote.get_nay().size() << OFF << ".";
 
-		if(secs_cast(cfg["for"]) > 0)
-			chan << " Effective for " << BOLD << secs_cast(secs_cast(cfg["for"])) << OFF << ".";
+		if(cfg.for_ > 0)
+			chan << " Effective for " << BOLD << secs_cast(cfg.for_) << OFF << ".";
 
 		chan << chan.flush;
-	}
+	});
 }
 
 
 void Vote::announce_vetoed()
 {
-	using namespace colors;
+	if(!get_conf().result.ack.chan)
+		return;
 
-	auto &chan(get_chan());
-	if(cfg.get("result.ack.chan",true))
-		chan << "The vote " << (*this) << " has been vetoed." << chan.flush;
+	praeco(Praeco::RESULT,get_chan_name(),[vote(VoteView(*this))]
+	{
+		auto &chan(get_chans().get(vote.get_chan_name()));
+		chan << "The vote " << vote << " has been vetoed." << chan.flush;
+	});
 }
 
 
 void Vote::announce_canceled()
 {
-	using namespace colors;
+	if(!get_conf().result.ack.chan)
+		return;
 
-	auto &chan(get_chan());
-	if(cfg.get("result.ack.chan",true))
-		chan << "The vote " << (*this) << " has been canceled." << chan.flush;
+	praeco(Praeco::RESULT,get_chan_name(),[vote(VoteView(*this))]
+	{
+		auto &chan(get_chans().get(vote.get_chan_name()));
+		chan << "The vote " << vote << " has been canceled." << chan.flush;
+	});
 }
 
 
 void Vote::announce_failed_required()
 {
-	using namespace colors;
+	if(!get_conf().result.ack.chan)
+		return;
+
+	praeco(Praeco::RESULT,get_chan_name(),[vote(VoteView(*this))]
+	{
+		using namespace colors;
 
-	auto &chan(get_chan());
-	if(cfg.get("result.ack.chan",true))
-		chan << (*this) << ": "
-		     << BOLD << get_type() << OFF << ": "
-		     << UNDER2 << get_issue() << OFF << ". "
+		auto &chan(get_chans().get(vote.get_chan_name()));
+		chan << vote << ": "
+		     << BOLD << vote.get_type() << OFF << ": "
+		     << UNDER2 << vote.get_issue() << OFF << ". "
 		     << FG::WHITE << BG::RED << BOLD << "The nays have it." << OFF
-		     << " Yeas: " << FG::GREEN << yea.size() << OFF << "."
-		     << " Nays: " << FG::RED << BOLD << nay.size() << OFF << "."
-		     << " Required at least: " << BOLD << calc_required(cfg,tally()) << OFF << " yeas."
+		     << " Yeas: " << FG::GREEN << vote.get_yea().size() << OFF << "."
+		     << " Nays: " << FG::RED << BOLD << vote.get_nay().size() << OFF << "."
+		     << " Required at least: " << BOLD << calc_required(vote.get_conf(),vote.tally()) << OFF << " yeas."
 		     << chan.flush;
+	});
 }
 
 
 void Vote::announce_failed_quorum()
 {
-	using namespace colors;
+	if(!get_conf().result.ack.chan)
+		return;
+
+	praeco(Praeco::RESULT,get_chan_name(),[vote(VoteView(*this))]
+	{
+		using namespace colors;
 
-	auto &chan(get_chan());
-	if(cfg.get("result.ack.chan",true))
-		chan << (*this) << ": "
+		auto &chan(get_chans().get(vote.get_chan_name()));
+		chan << vote << ": "
 		     << "Failed to reach a quorum: "
-		     << BOLD << total() << OFF
+		     << BOLD << vote.total() << OFF
 		     << " of "
-		     << BOLD << get_quorum() << OFF
+		     << BOLD << vote.get_quorum() << OFF
 		     << " required."
 		     << chan.flush;
+	});
 }
 
 
 void Vote::announce_ballot_accept(User &user,
                                   const Stat &stat)
 {
-	const auto &cfg(get_cfg());
-	switch(stat)
-	{
-		case Stat::ADDED:
-		{
-			if(cfg.get("ballot.ack.chan",false))
-			{
-				auto &chan(get_chan());
-				chan << user << "Thanks for casting your vote on " << (*this) << "!" << chan.flush;
-			}
+	if(aggregated())
+		return;
 
-			if(cfg.get("ballot.ack.priv",true))
-				user << "Thanks for casting your vote on " << (*this) << "!" << user.flush;
+	if(acks && &acks->get_user() == &user)
+	{
+		acks->accept(*this,stat);
+		return;
+	}
 
-			break;
-		}
+	const auto &cfg(get_conf());
+	const auto what(stat == Stat::CHANGED? "You have changed your vote on " : "Thanks for casting your vote on ");
+	const auto merge("ballot " + id + " " + user.get_acct());
 
-		case Stat::CHANGED:
+	// A ballot changed again before its ack was sent supersedes that ack
+	if(cfg.ballot.ack.chan)
+		praeco(Praeco::ACK,get_chan_name(),[chan(get_chan_name()),nick(user.get_nick()),id(get_id()),what]
 		{
-			if(cfg.get("ballot.ack.chan",false))
-			{
-				auto &chan(get_chan());
-				chan << user << "You have changed your vote on " << (*this) << "!" << chan.flush;
-			}
+			using namespace colors;
 
-			if(cfg.get("ballot.ack.priv",true))
-				user << "You have changed your vote on " << (*this) << "!" << user.flush;
+			auto &c(get_chans().get(chan));
+			auto &u(get_users().get(nick));
+			c << u << what << "#" << BOLD << id << OFF << "!" << c.flush;
+		},merge + " chan");
 
-			break;
-		}
-	}
+	if(cfg.ballot.ack.priv)
+		praeco(Praeco::ACK,user.get_nick(),[nick(user.get_nick()),id(get_id()),what]
+		{
+			using namespace colors;
+
+			auto &u(get_users().get(nick));
+			u << what << "#" << BOLD << id << OFF << "!" << u.flush;
+		},merge + " priv");
 }
 
 
 void Vote::announce_ballot_reject(User &user,
                                   const std::string &reason)
 {
-	const auto &cfg(get_cfg());
-	if(cfg.get("ballot.rej.chan",false))
+	if(acks && &acks->get_user() == &user)
 	{
-		auto &chan(get_chan());
-		chan << user << "Your vote was not accepted for " << (*this) << ": " << reason << chan.flush;
+		acks->reject(*this,reason);
+		return;
 	}
 
-	if(cfg.get("ballot.rej.priv",true))
-		user << "Your vote was not accepted for " << (*this) << ": " << reason << user.flush;
+	const auto &cfg(get_conf());
+	const auto merge("ballot " + id + " " + user.get_acct());
+
+	if(cfg.ballot.rej.chan)
+		praeco(Praeco::ACK,get_chan_name(),[chan(get_chan_name()),nick(user.get_nick()),id(get_id()),reason]
+		{
+			using namespace colors;
+
+			auto &c(get_chans().get(chan));
+			auto &u(get_users().get(nick));
+			c << u << "Your vote was not accepted for " << "#" << BOLD << id << OFF << ": " << reason << c.flush;
+		},merge + " chan");
+
+	if(cfg.ballot.rej.priv)
+		praeco(Praeco::ACK,user.get_nick(),[nick(user.get_nick()),id(get_id()),reason]
+		{
+			using namespace colors;
+
+			auto &u(get_users().get(nick));
+			u << "Your vote was not accepted for " << "#" << BOLD << id << OFF << ": " << reason << u.flush;
+		},merge + " priv");
 }
 
 
@@ -540,24 +963,22 @@ const
 bool Vote::prejudiced()
 const
 {
-	const Adoc &cfg(get_cfg());
-	if(!cfg.get("quorum.prejudice",false))
+	if(!get_conf().quorum.prejudice)
 		return false;
 
-	return yea.size() >= calc_required(cfg,tally());
+	return yea.size() >= calc_required(get_conf(),tally());
 }
 
 
 bool Vote::interceded()
 const
 {
-	const auto vmin(std::max(cfg.get("veto.quorum",1U),1U));
+	const auto vmin(std::max(get_conf().veto.quorum,1U));
 	const auto num_vetoes(get_veto().size());
 	if(num_vetoes < vmin)
 		return false;
 
-	const auto quick(cfg.get("veto.quick",true));
-	return quick? true : !remaining();
+	return get_conf().veto.quick? true : !remaining();
 }
 
 
@@ -570,44 +991,45 @@ Locutor &operator<<(Locutor &locutor,
 }
 
 
-uint calc_required(const Adoc &cfg,
+Locutor &operator<<(Locutor &locutor,
+                    const VoteView &vote)
+{
+	using namespace colors;
+
+	return locutor << "#" << BOLD << vote.get_id() << OFF;
+}
+
+
+uint calc_required(const VoteConfig &cfg,
                    const Tally &tally)
 {
 	const std::vector<uint> sel
 	{{
 		calc_plurality(cfg,tally),
-		cfg.get("quorum.yea",0U)
+		cfg.quorum.yea
 	}};
 
 	return *std::max_element(sel.begin(),sel.end());
 }
 
 
-uint calc_plurality(const Adoc &cfg,
+uint calc_plurality(const VoteConfig &cfg,
                     const Tally &tally)
 {
 	const auto &yea(tally.first);
 	const auto &nay(tally.second);
 	const auto total(yea + nay);
 	const float count((total - yea) + nay);
-	return ceil(count * cfg.get("quorum.plurality",0.51));
+	return ceil(count * cfg.quorum.plurality);
 }
 
 
-uint calc_quorum(const Adoc &cfg,
+uint calc_quorum(const VoteConfig &cfg,
                  const Chan &chan,
                  time_t began)
 {
-	std::vector<uint> sel
-	{{
-		cfg.get("quorum.yea",1U),
-		cfg.get("quorum.ballots",1U),
-		0
-	}};
-
-	const auto turnout(cfg.get("quorum.turnout",0.0));
-	if(turnout <= 0.0)
-		return *std::max_element(sel.begin(),sel.end());
+	if(cfg.quorum.turnout <= 0.0)
+		return calc_quorum(cfg,0);
 
 	if(!began)
 		time(&began);
@@ -620,7 +1042,7 @@ uint calc_quorum(const Adoc &cfg,
 			count.emplace(user.get_acct(),0);
 	});
 
-	const auto min_age(secs_cast(cfg["quorum.age"]));
+	const auto &min_age(cfg.quorum.age);
 	const auto start_time(began - min_age);
 	irc::log::for_each(chan.get_name(),[&count,&start_time]
 	(const irc::log::ClosureArgs &a)
@@ -644,7 +1066,7 @@ uint calc_quorum(const Adoc &cfg,
 		return true;
 	});
 
-	const auto min_lines(cfg.get("quorum.lines",0U));
+	const auto &min_lines(cfg.quorum.lines);
 	const auto has_lines(std::count_if(count.begin(),count.end(),[&min_lines]
 	(const auto &p)
 	{
@@ -653,64 +1075,77 @@ uint calc_quorum(const Adoc &cfg,
 		return lines >= min_lines;
 	}));
 
-	sel.back() = ceil(has_lines * turnout);
+	return calc_quorum(cfg,has_lines);
+}
+
+
+uint calc_quorum(const VoteConfig &cfg,
+                 const size_t &turnout)
+{
+	const std::vector<uint> sel
+	{{
+		cfg.quorum.has_yea? cfg.quorum.yea : 1U,
+		cfg.quorum.ballots,
+		cfg.quorum.turnout > 0.0? uint(ceil(turnout * cfg.quorum.turnout)) : 0U
+	}};
+
 	return *std::max_element(sel.begin(),sel.end());
 }
 
 
-bool speaker(const Adoc &cfg,
+bool speaker(const VoteConfig &cfg,
              const Chan &chan,
              const User &user)
 {
-	if(!cfg.get("enable",false))
+	if(!cfg.enable)
 		return false;
 
 	if(!user.is_logged_in())
 		return false;
 
-	return (!cfg.has("speaker.access") || has_access(chan,user,cfg.get("speaker.access",Mode{}))) &&
-	       (!cfg.has("speaker.mode") || has_mode(chan,user,cfg.get("speaker.mode",Mode{})));
+	return (!cfg.speaker.has_access || has_access(chan,user,cfg.speaker.access)) &&
+	       (!cfg.speaker.has_mode || has_mode(chan,user,cfg.speaker.mode));
 }
 
 
-bool intercession(const Adoc &cfg,
+bool intercession(const VoteConfig &cfg,
                   const Chan &chan,
                   const User &user)
 {
-	if(!cfg.get("enable",false))
+	if(!cfg.enable)
 		return false;
 
 	if(!user.is_logged_in())
 		return false;
 
-	if(cfg.has("veto.mode") && !has_mode(chan,user,cfg.get("veto.mode",Mode{})))
+	if(cfg.veto.has_mode && !has_mode(chan,user,cfg.veto.mode))
 		return false;
 
-	if(cfg.has("veto.access") && !has_access(chan,user,cfg.get("veto.access",Mode{})))
+	if(cfg.veto.has_access && !has_access(chan,user,cfg.veto.access))
 		return false;
 
-	return cfg.has("veto.access") || cfg.has("veto.mode");
+	return cfg.veto.has_access || cfg.veto.has_mode;
 }
 
 
-bool qualified(const Adoc &cfg,
+bool qualified(const VoteConfig &cfg,
                const Chan &chan,
                const User &user,
                time_t began)
 {
-	if(!cfg.get("enable",false))
+	if(!cfg.enable)
 		return false;
 
 	if(!user.is_logged_in())
 		return false;
 
-	if(has_access(chan,user,cfg.get("qualify.access",Mode{})))
+	if(has_access(chan,user,cfg.qualify.access))
 		return true;
 
 	if(!began)
 		time(&began);
 
-	const auto age(secs_cast(cfg.get("qualify.age","10m")));
+	const auto &age(cfg.qualify.age);
 	const auto &endtime(began - age);
 	const auto &acct(user.get_acct());
 	const irc::log::FilterAll filt([&acct,&endtime]
@@ -725,31 +1160,31 @@ bool qualified(const Adoc &cfg,
 		return strncmp(a.acct,acct.c_str(),16) == 0;
 	});
 
-	const auto lines(cfg.get("qualify.lines",0U));
+	const auto &lines(cfg.qualify.lines);
 	return irc::log::atleast(chan.get_name(),filt,lines);
 }
 
 
-bool enfranchised(const Adoc &cfg,
+bool enfranchised(const VoteConfig &cfg,
                   const Chan &chan,
                   const User &user,
                   time_t began)
 {
-	if(!cfg.get("enable",false))
+	if(!cfg.enable)
 		return false;
 
 	if(!user.is_logged_in())
 		return false;
 
-	const auto mode(cfg.get("enfranchise.mode",Mode{}));
-	const auto access(cfg.get("enfranchise.access",Mode{}));
+	const auto &mode(cfg.enfranchise.mode);
+	const auto &access(cfg.enfranchise.access);
 	if(!mode.empty() || !access.empty())
 		return has_mode(chan,user,mode) || has_access(chan,user,access);
 
 	if(!began)
 		time(&began);
 
-	const auto age(secs_cast(cfg.get("enfranchise.age","30m")));
+	const auto &age(cfg.enfranchise.age);
 	const auto endtime(began - age);
 	const auto &acct(user.get_acct());
 	const irc::log::FilterAll filt([&acct,&endtime]
@@ -764,7 +1199,7 @@ bool enfranchised(const Adoc &cfg,
 		return strncmp(a.acct,acct.c_str(),16) == 0;
 	});
 
-	const auto lines(cfg.get("enfranchise.lines",0U));
+	const auto &lines(cfg.enfranchise.lines);
 	return irc::log::atleast(chan.get_name(),filt,lines);
 }
 
@@ -823,3 +1258,110 @@ bool is_ballot(const std::string &str)
 {
 	return ystr.count(str) || nstr.count(str);
 }
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Ballots
+//
+
+
+Ballots::Ballots(const Adoc &doc)
+{
+	ids.reserve(doc.size());
+	for(const auto &pair : doc)
+		ids.emplace_back(interned(pair.second.get("",std::string{})));
+
+	std::sort(ids.begin(),ids.end());
+	ids.erase(std::unique(ids.begin(),ids.end()),ids.end());
+}
+
+
+Ballots::operator Adoc()
+const
+{
+	Adoc ret;
+	for(const auto &name : names())
+		ret.push(name);
+
+	return ret;
+}
+
+
+size_t Ballots::erase(const std::string &name)
+{
+	const auto id(interned.find(name));
+	const auto it(std::lower_bound(ids.begin(),ids.end(),id));
+	if(id == interned.NONE || it == ids.end() || *it != id)
+		return 0;
+
+	ids.erase(it);
+	return 1;
+}
+
+
+bool Ballots::emplace(const std::string &name)
+{
+	const auto id(interned(name));
+	const auto it(std::lower_bound(ids.begin(),ids.end(),id));
+	if(it != ids.end() && *it == id)
+		return false;
+
+	ids.insert(it,id);
+	return true;
+}
+
+
+std::set<std::string> Ballots::names()
+const
+{
+	std::set<std::string> ret;
+	for(const auto &id : ids)
+		ret.emplace(interned[id]);
+
+	return ret;
+}
+
+
+size_t Ballots::count(const std::string &name)
+const
+{
+	const auto id(interned.find(name));
+	return id != interned.NONE && std::binary_search(ids.begin(),ids.end(),id);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Interned
+//
+
+
+uint Interned::operator()(const std::string &name)
+{
+	const std::lock_guard<decltype(mutex)> lock(mutex);
+	const auto iit(ids.emplace(name,names.size()));
+	if(iit.second)
+		names.emplace_back(&iit.first->first);
+
+	return iit.first->second;
+}
+
+
+uint Interned::find(const std::string &name)
+const
+{
+	const std::lock_guard<decltype(mutex)> lock(mutex);
+	const auto it(ids.find(name));
+	return it != ids.end()? it->second : NONE;
+}
+
+
+const std::string &Interned::operator[](const uint &id)
+const
+{
+	const std::lock_guard<decltype(mutex)> lock(mutex);
+	return *names.at(id);
+}
@@ -6,6 +6,8 @@
  */
 
 
+struct Vdb;
+
 enum class Ballot
 {
 	YEA,
@@ -31,37 +33,99 @@ std::ostream &operator<<(std::ostream &s, const Ballot &ballot);
 bool has_access(const Chan &chan, const User &user, const Mode &mode);
 bool has_mode(const Chan &chan, const User &user, const Mode &mode);
 
-bool enfranchised(const Adoc &cfg, const Chan &chan, const User &user, time_t began = 0);
-bool qualified(const Adoc &cfg, const Chan &chan, const User &user, time_t began = 0);
-bool intercession(const Adoc &cfg, const Chan &chan, const User &user);
-bool speaker(const Adoc &cfg, const Chan &chan, const User &user);
+bool enfranchised(const VoteConfig &cfg, const Chan &chan, const User &user, time_t began = 0);
+bool qualified(const VoteConfig &cfg, const Chan &chan, const User &user, time_t began = 0);
+bool intercession(const VoteConfig &cfg, const Chan &chan, const User &user);
+bool speaker(const VoteConfig &cfg, const Chan &chan, const User &user);
+
+uint calc_quorum(const VoteConfig &cfg, const size_t &turnout);     // turnout: qualifying accounts present
+uint calc_quorum(const VoteConfig &cfg, const Chan &chan, time_t began = 0);
+uint calc_plurality(const VoteConfig &cfg, const Tally &tally);
+uint calc_required(const VoteConfig &cfg, const Tally &tally);
+
+
+// Account and host names are interned once for the process; ballots only
+// hold the number of a name. Entries live as long as the process, so only
+// the ballots of a Vote intern: those of open votes and of the few the
+// Praetor loads to expire. A VoteView keeps its names as strings.
+class Interned
+{
+	mutable std::mutex mutex;
+	std::unordered_map<std::string, uint> ids;      // name => number
+	std::vector<const std::string *> names;         // number => name (keys of ids are stable)
+
+  public:
+	static constexpr uint NONE = std::numeric_limits<uint>::max();
+
+	const std::string &operator[](const uint &id) const;
+	uint find(const std::string &name) const;       // NONE if the name was never interned
+	uint operator()(const std::string &name);       // Interns the name if required
+};
+
+extern Interned interned;
+
+
+// Set of names stored as a vector of interned numbers ordered by number.
+// Only listing the names orders them by name, so it serializes to the same
+// JSON array of strings as the std::set<std::string> it replaced.
+class Ballots
+{
+	std::vector<uint> ids;                          // Ordered by the interned number
+
+  public:
+	auto empty() const                              { return ids.empty();                                }
+	auto size() const                               { return ids.size();                                 }
+	size_t count(const std::string &name) const;
+	std::set<std::string> names() const;
+
+	bool emplace(const std::string &name);          // true if the name was added
+	size_t erase(const std::string &name);
+
+	operator Adoc() const;
+
+	Ballots() = default;
+	explicit Ballots(const Adoc &doc);
+};
 
-uint calc_quorum(const Adoc &cfg, const Chan &chan, time_t began = 0);
-uint calc_plurality(const Adoc &cfg, const Tally &tally);
-uint calc_required(const Adoc &cfg, const Tally &tally);
 
 class Vote : protected Acct
 {
+  public:
+	class Acks;
+
+  private:
 	static const std::string ARG_KEYED;
 	static const std::string ARG_VALUED;
+	static Acks *acks;                          // Innermost open Acks, if any
 
+	Vdb &vdb;                                   // Database of this vote and its ballot journal
 	std::string id;                             // Index ID of vote (stored as string for Acct db)
 	std::string type;                           // Type name of this vote
 	std::string chan;                           // Name of the channel
 	std::string nick;                           // Nick of initiating user (note: don't trust)
 	std::string acct;                           // $a name of initiating user
 	std::string issue;                          // "Issue" input of the vote
-	Adoc cfg;                                   // Configuration of this vote
+	Snap base;                                  // Shared config the vote was made under
+	Adoc delta;                                 // Overrides of base: audibles, ctor cfg, adjusted "for"
+	Snap cfg;                                   // Configuration of this vote: base unless there is a delta
 	time_t began;                               // Time vote was activated or 0
 	time_t ended;                               // Time vote was closed or 0
 	time_t expiry;                              // Time vote effects successfully expired.
 	size_t quorum;                              // Quorum required
 	std::string reason;                         // Reason for failure; no reason is passed vote
 	std::string effect;                         // Effects of outcome; only filled once effective
-	std::set<std::string> yea;                  // Accounts voting Yes
-	std::set<std::string> nay;                  // Accounts voting No
-	std::set<std::string> veto;                 // Accounts voting No with intent to veto
-	std::set<std::string> hosts;                // Hostnames that have voted
+	Adoc state;                                 // Kept by the type of vote for itself
+	Ballots yea;                                // Accounts voting Yes
+	Ballots nay;                                // Accounts voting No
+	Ballots veto;                               // Accounts voting No with intent to veto
+	Ballots hosts;                              // Hostnames that have voted
+	size_t folded;                              // Journal sequence included by the saved document
+	size_t journaled;                           // Journal sequence of the next ballot
+	time_t ack_since;                           // Start of the window of ballot acks
+	uint ack_count;                             // Ballots accepted in the window
+	uint ack_held;                              // Ballots whose acks are held for the summary
+
+	void journal(const User &user, const Ballot &ballot, const Stat &stat);
 
   public:
 	auto get_id() const                         { return lex_cast<id_t>(id);                        }
@@ -72,23 +136,26 @@ class Vote : protected Acct
 	auto &get_chan() const                      { return chans->get(get_chan_name());               }
 	auto &get_user() const                      { return users->get(get_user_nick());               }
 	auto &get_issue() const                     { return issue;                                     }
-	auto &get_cfg() const                       { return cfg;                                       }
+	auto &get_cfg() const                       { return cfg->doc;                                  }
+	auto &get_conf() const                      { return cfg->conf;                                 }
+	auto &get_snap() const                      { return cfg;                                       }
 	auto &get_began() const                     { return began;                                     }
 	auto &get_ended() const                     { return ended;                                     }
 	auto &get_expiry() const                    { return expiry;                                    }
 	auto &get_reason() const                    { return reason;                                    }
 	auto &get_effect() const                    { return effect;                                    }
+	auto &get_state() const                     { return state;                                     }
 	auto &get_yea() const                       { return yea;                                       }
 	auto &get_nay() const                       { return nay;                                       }
 	auto &get_hosts() const                     { return hosts;                                     }
 	auto &get_veto() const                      { return veto;                                      }
 	auto &get_quorum() const                    { return quorum;                                    }
 	auto elapsed() const                        { return time(NULL) - get_began();                  }
-	auto remaining() const                      { return secs_cast(cfg["duration"]) - elapsed();    }
-	auto expires() const                        { return get_ended() + secs_cast(cfg["for"]);       }
+	auto remaining() const                      { return get_conf().duration - elapsed();           }
+	auto expires() const                        { return get_ended() + get_conf().for_;             }
 	auto tally() const -> Tally                 { return { yea.size(), nay.size() };                }
 	auto total() const                          { return yea.size() + nay.size();                   }
-	bool enabled() const                        { return cfg.get("enable",false);                   }
+	bool enabled() const                        { return get_conf().enable;                         }
 	bool interceded() const;
 	bool prejudiced() const;
 
@@ -99,15 +166,19 @@ class Vote : protected Acct
 	Ballot position(const User &user) const     { return position(user.get_acct());                 }
 
   protected:
-	void set_cfg(const Adoc &cfg)               { this->cfg = cfg;                                  }
+	template<class T> void set_cfg(const std::string &key, const T &val);
 	void set_issue(const std::string &issue)    { this->issue = issue;                              }
 	void set_reason(const std::string &reason)  { this->reason = reason;                            }
 	void set_effect(const std::string &effect)  { this->effect = effect;                            }
+	template<class T> void set_state(const std::string &key, const T &val)   { state.put(key,val);  }
 	void set_began()                            { time(&began);                                     }
 	void set_ended()                            { time(&ended);                                     }
 	void set_expiry()                           { time(&expiry);                                    }
 	void set_quorum(const uint &quorum)         { this->quorum = quorum;                            }
 
+	Stat accept(User &u, const Ballot &b);      // event_vote() without acknowledgement; throws rejections
+	bool aggregated();                          // Counts an accepted ballot; true if its ack is held
+
 	void announce_ballot_reject(User &user, const std::string &reason);
 	void announce_ballot_accept(User &user, const Stat &stat);
 	void announce_failed_required();
@@ -136,21 +207,22 @@ class Vote : protected Acct
 	operator Adoc() const;                      // Serialize to Adoc/JSON
 
 	// Main controls used by Voting / Praetor
-	void save()                                 { Acct::set(*this);                                 }
+	void save();                                // Writes behind the whole document, folding the journal
 	void start();
 	void finish();
 	void cancel();
 	void expire();
+	void announce_ballots(const bool &now = false);  // Summary of held acks when their window closes, or now
 
 	// Deserialization ctor
 	Vote(const std::string &type,               // Dummy argument to match main ctor for ...'s
 	     const id_t &id,
-	     Adb &adb);
+	     Vdb &vdb);
 
 	// Motion ctor (main ctor)
 	Vote(const std::string &type,
 	     const id_t &id,
-	     Adb &adb,
+	     Vdb &vdb,
 	     Chan &chan,
 	     User &user,
 	     const std::string &issue,
@@ -160,3 +232,102 @@ class Vote : protected Acct
 
 	friend Locutor &operator<<(Locutor &l, const Vote &v);  // Appends formatted #ID to the stream
 };
+
+
+// Acknowledgements of the ballots one user casts on several votes at once.
+// While an Acks is open for the user, event_vote() reports to it rather than
+// acknowledging each ballot, and it lists them when it closes: one line to
+// each channel and one to the user, with changed ballots apart from new ones.
+// Callers must hold the Bot lock.
+class Vote::Acks
+{
+	using Accepted = std::vector<std::pair<id_t, Stat>>;
+	using Rejected = std::vector<std::pair<id_t, std::string>>;
+
+	User &user;
+	Acks *const outer;                               // Acks open when this one was opened
+	std::map<std::string, Accepted> chan_acks;       // Acknowledged in channel : chan => ballots
+	std::map<std::string, Rejected> chan_rejs;       // Rejected in channel : chan => ballots
+	Accepted priv_acks;
+	Rejected priv_rejs;
+
+	static void list(Locutor &out, const Accepted &acks);
+	static void list(Locutor &out, const Rejected &rejs);
+
+  public:
+	auto &get_user() const                           { return user;                             }
+
+	void accept(const Vote &vote, const Stat &stat);
+	void reject(const Vote &vote, const std::string &reason);
+	void reject(const id_t &id, const std::string &reason);     // No such vote; told to the user
+
+	Acks(User &user);
+	Acks(const Acks &) = delete;
+	Acks &operator=(const Acks &) = delete;
+	~Acks() noexcept;
+};
+
+
+// Flat read-only record of a vote for rendering. It is decoded straight from
+// the stored document without constructing the Vote subclass, or copied from
+// a live vote. Ballots of an open vote include those journaled since its
+// last save.
+class VoteView
+{
+	id_t id;
+	std::string type;
+	std::string chan;
+	std::string acct;
+	std::string issue;
+	Snap cfg;
+	time_t began;
+	time_t ended;
+	time_t expiry;
+	size_t quorum;
+	std::string reason;
+	std::string effect;
+	std::set<std::string> yea;
+	std::set<std::string> nay;
+	std::set<std::string> veto;
+	std::set<std::string> hosts;
+
+  public:
+	auto &get_id() const                        { return id;                                        }
+	auto &get_type() const                      { return type;                                      }
+	auto &get_chan_name() const                 { return chan;                                      }
+	auto &get_user_acct() const                 { return acct;                                      }
+	auto &get_issue() const                     { return issue;                                     }
+	auto &get_cfg() const                       { return cfg->doc;                                  }
+	auto &get_conf() const                      { return cfg->conf;                                 }
+	auto &get_began() const                     { return began;                                     }
+	auto &get_ended() const                     { return ended;                                     }
+	auto &get_expiry() const                    { return expiry;                                    }
+	auto &get_reason() const                    { return reason;                                    }
+	auto &get_effect() const                    { return effect;                                    }
+	auto &get_yea() const                       { return yea;                                       }
+	auto &get_nay() const                       { return nay;                                       }
+	auto &get_veto() const                      { return veto;                                      }
+	auto &get_quorum() const                    { return quorum;                                    }
+	auto elapsed() const                        { return time(NULL) - get_began();                  }
+	auto remaining() const                      { return get_conf().duration - elapsed();           }
+	auto expires() const                        { return get_ended() + get_conf().for_;             }
+	auto tally() const -> Tally                 { return { yea.size(), nay.size() };                }
+	auto total() const                          { return yea.size() + nay.size();                   }
+
+	Ballot position(const User &user) const;    // Throws if user hasn't taken a position
+	bool voted(const User &user) const;
+
+	VoteView(const Adoc &doc, Vdb &vdb);        // Document as stored by Vdb
+	VoteView(const Vote &vote);
+
+	friend Locutor &operator<<(Locutor &l, const VoteView &v);  // Appends formatted #ID to the stream
+};
+
+
+template<class T>
+void Vote::set_cfg(const std::string &key,
+                   const T &val)
+{
+	delta.put(key,val);
+	cfg = snapshots(base,delta);
+}
@@ -12,6 +12,8 @@ using namespace irc::bot;
 
 // SPQF
 #include "log.h"
+#include "lictor.h"
+#include "confs.h"
 #include "vote.h"
 #include "votes.h"
 
@@ -42,12 +44,22 @@ decltype(vote::names) vote::names
 	"flags",
 	"import",
 	"civis",
+	"cives",
 	"censure",
 	"staff",
 	"destaff",
 }};
 
 
+// Mask a list mode puts on the user at issue: the account when logged in, else the host,
+// as the except and invex lists are checked
+static
+Mask effect_mask(const User &user)
+{
+	return user.is_logged_in()? user.mask(Mask::ACCT) : user.mask(Mask::HOST);
+}
+
+
 
 ///////////////////////////////////////////////////////////////////////////////
 //
@@ -104,6 +116,7 @@ void vote::Import::passed()
 
 	auto &chan(get_chan());
 	chan.set("config.vote",received.str());
+	confs.invalidate(chan);
 
 	chan << "Applied new configuration"
 	     << " (received " << received.str().size() << " bytes)"
@@ -121,7 +134,9 @@ void vote::Import::passed()
 void vote::UnQuiet::effective()
 {
 	auto &chan(get_chan());
-	set_effect(chan.unquiet(user));
+	const auto deltas(chan::compose(chan.lists.quiets,user,"-q"));
+	lictor(chan,deltas);
+	set_effect(deltas);
 }
 
 
@@ -148,7 +163,9 @@ void vote::Quiet::starting()
 void vote::Quiet::effective()
 {
 	auto &chan(get_chan());
-	set_effect(chan.quiet(user));
+	const Delta delta("+q",effect_mask(user));
+	lictor(chan,delta);
+	set_effect(delta);
 }
 
 
@@ -170,7 +187,9 @@ void vote::DeVoice::starting()
 void vote::DeVoice::effective()
 {
 	auto &chan(get_chan());
-	set_effect(chan.devoice(user));
+	const Delta delta("-v",user.get_nick());
+	lictor(chan,delta);
+	set_effect(delta);
 }
 
 
@@ -192,7 +211,9 @@ void vote::Voice::starting()
 void vote::Voice::effective()
 {
 	auto &chan(get_chan());
-	set_effect(chan.voice(user));
+	const Delta delta("+v",user.get_nick());
+	lictor(chan,delta);
+	set_effect(delta);
 }
 
 
@@ -219,7 +240,9 @@ void vote::Ban::starting()
 void vote::Ban::effective()
 {
 	auto &chan(get_chan());
-	set_effect(chan.ban(user));
+	const Delta delta("+b",effect_mask(user));
+	lictor(chan,delta);
+	set_effect(delta);
 }
 
 
@@ -273,12 +296,14 @@ try
 	{
 		const auto &users(get_users());
 		const auto &user(users.get(mask));
-		set_effect(chan.unban(user));
+		const auto deltas(chan::compose(chan.lists.bans,user,"-b"));
+		lictor(chan,deltas);
+		set_effect(deltas);
 		return;
 	}
 
 	const Delta delta("-b",mask);
-	chan(delta);
+	lictor(chan,delta);
 	set_effect(delta);
 }
 catch(const Exception &e)
@@ -306,7 +331,9 @@ void vote::Op::starting()
 void vote::Op::effective()
 {
 	auto &chan(get_chan());
-	set_effect(chan.op(user));
+	const Delta delta("+o",user.get_nick());
+	lictor(chan,delta);
+	set_effect(delta);
 }
 
 
@@ -328,7 +355,9 @@ void vote::DeOp::starting()
 void vote::DeOp::effective()
 {
 	auto &chan(get_chan());
-	set_effect(chan.deop(user));
+	const Delta delta("-o",user.get_nick());
+	lictor(chan,delta);
+	set_effect(delta);
 }
 
 
@@ -355,7 +384,9 @@ void vote::Exempt::starting()
 void vote::Exempt::effective()
 {
 	auto &chan(get_chan());
-	set_effect(chan.except(user));
+	const Delta delta("+e",effect_mask(user));
+	lictor(chan,delta);
+	set_effect(delta);
 }
 
 
@@ -396,12 +427,14 @@ try
 	{
 		const auto &users(get_users());
 		const auto &user(users.get(mask));
-		set_effect(chan.unexcept(user));
+		const auto deltas(chan::compose(chan.lists.excepts,user,"-e"));
+		lictor(chan,deltas);
+		set_effect(deltas);
 		return;
 	}
 
 	const auto deltas(chan::compose(chan.lists.excepts,user,"-e"));
-	chan(deltas);
+	lictor(chan,deltas);
 	set_effect(deltas);
 }
 catch(const Exception &e)
@@ -434,7 +467,9 @@ void vote::Invex::starting()
 void vote::Invex::effective()
 {
 	auto &chan(get_chan());
-	set_effect(chan.invex(user));
+	const Delta delta("+I",effect_mask(user));
+	lictor(chan,delta);
+	set_effect(delta);
 }
 
 
@@ -475,12 +510,14 @@ try
 	{
 		const auto &users(get_users());
 		const auto &user(users.get(mask));
-		set_effect(chan.uninvex(user));
+		const auto deltas(chan::compose(chan.lists.invites,user,"-I"));
+		lictor(chan,deltas);
+		set_effect(deltas);
 		return;
 	}
 
 	const auto deltas(chan::compose(chan.lists.invites,user,"-I"));
-	chan(deltas);
+	lictor(chan,deltas);
 	set_effect(deltas);
 }
 catch(const Exception &e)
@@ -508,7 +545,7 @@ void vote::Flags::passed()
 	effect << user.get_acct() << " " << deltas;
 
 	auto &chan(get_chan());
-	chan.flags(user,deltas);
+	lictor.flags(chan,user,deltas);
 	set_effect(effect.str());
 }
 
@@ -525,7 +562,7 @@ void vote::Flags::expired()
 
 	const Deltas deltas(toks.at(1));
 	auto &chan(get_chan());
-	chan.flags(user,~deltas);
+	lictor.flags(chan,user,~deltas);
 }
 
 
@@ -628,7 +665,7 @@ void vote::Civis::passed()
 	effect << user.get_acct() << " " << delta;
 
 	auto &chan(get_chan());
-	chan.flags(user,delta);
+	lictor.flags(chan,user,delta);
 	set_effect(effect.str());
 }
 
@@ -637,7 +674,119 @@ void vote::Civis::expired()
 {
 	const Delta delta("-V");
 	auto &chan(get_chan());
-	chan.flags(user,delta);
+	lictor.flags(chan,user,delta);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Cives - Civis for a batch of accounts
+//
+
+
+void vote::Cives::starting()
+{
+	const auto &chan(get_chan());
+	const auto &cfg(get_cfg());
+
+	const auto accts(tokens(get_issue()));
+	if(accts.size() < 2)
+		throw Exception("A bulk civis vote needs at least two accounts at issue");
+
+	const Adoc excludes(cfg.get_child("civis.eligible.exclude",Adoc{}));
+	const auto exclude(excludes.into<std::set<std::string>>());
+	const bool any(std::any_of(accts.begin(),accts.end(),[&chan,&exclude]
+	(const std::string &acct)
+	{
+		const User user(acct,"",acct);
+		return !exclude.count(acct) && !chan.lists.has_flag(user,'V');
+	}));
+
+	if(!any)
+		throw Exception("No account at issue can be enfranchised");
+}
+
+
+void vote::Cives::passed()
+{
+	auto &chan(get_chan());
+	const auto &cfg(get_cfg());
+	const Adoc excludes(cfg.get_child("civis.eligible.exclude",Adoc{}));
+	const auto exclude(excludes.into<std::set<std::string>>());
+
+	std::stringstream effect;
+	effect << "+V";
+	for(const auto &acct : admitted())
+	{
+		const User user(acct,"",acct);
+		if(exclude.count(acct) || chan.lists.has_flag(user,'V'))
+			continue;
+
+		lictor.flags(chan,user,Delta("+V"));
+		effect << " " << acct;
+	}
+
+	set_effect(effect.str());
+}
+
+
+void vote::Cives::expired()
+{
+	const auto toks(tokens(get_effect()));
+	if(toks.empty())
+		return;
+
+	auto &chan(get_chan());
+	for(auto it(toks.begin() + 1); it != toks.end(); ++it)
+	{
+		const User user(*it,"",*it);
+		lictor.flags(chan,user,Delta("-V"));
+	}
+}
+
+
+size_t vote::Cives::strike(const User &user,
+                           const std::string &acct)
+{
+	if(!get_began() || get_ended())
+		throw Exception("Accounts can only be struck while the vote is open.");
+
+	const auto accts(tokens(get_issue()));
+	if(std::find(accts.begin(),accts.end(),acct) == accts.end())
+		throw Exception("That account is not at issue in this vote.");
+
+	if(!intercession(get_conf(),get_chan(),user))
+		throw Exception("You are not able to strike accounts from this vote.");
+
+	auto struck(strikes(acct));
+	if(std::find(struck.begin(),struck.end(),user.get_acct()) != struck.end())
+		throw Exception("You have already struck that account.");
+
+	struck.emplace_back(user.get_acct());
+	set_state("strikes." + acct,detok(struck.begin(),struck.end()));
+	save();
+	return struck.size();
+}
+
+
+std::vector<std::string> vote::Cives::admitted()
+const
+{
+	const auto vmin(std::max(get_conf().veto.quorum,1U));
+	std::vector<std::string> ret;
+	for(const auto &acct : tokens(get_issue()))
+		if(strikes(acct).size() < vmin)
+			ret.emplace_back(acct);
+
+	return ret;
+}
+
+
+std::vector<std::string> vote::Cives::strikes(const std::string &acct)
+const
+{
+	return tokens(get_state().get("strikes." + acct,std::string{}));
 }
 
 
@@ -664,7 +813,7 @@ void vote::Censure::passed()
 	effect << user.get_acct() << " " << delta;
 
 	Chan &chan(get_chan());
-	chan.flags(user,delta);
+	lictor.flags(chan,user,delta);
 	set_effect(effect.str());
 }
 
@@ -673,7 +822,7 @@ void vote::Censure::expired()
 {
 	const Delta delta("+V");
 	Chan &chan(get_chan());
-	chan.flags(user,delta);
+	lictor.flags(chan,user,delta);
 }
 
 
@@ -713,7 +862,7 @@ void vote::Staff::passed()
 	auto &chan(get_chan());
 	const auto &cfg(get_cfg());
 	const Deltas deltas(std::string("+") + cfg["staff.access"]);
-	chan.flags(user,deltas);
+	lictor.flags(chan,user,deltas);
 	set_effect(deltas);
 }
 
@@ -722,7 +871,7 @@ void vote::Staff::expired()
 {
 	auto &chan(get_chan());
 	const Deltas deltas(get_effect());
-	chan.flags(user,~deltas);
+	lictor.flags(chan,user,~deltas);
 }
 
 
@@ -752,7 +901,7 @@ void vote::DeStaff::passed()
 	auto &chan(get_chan());
 	const auto &cfg(get_cfg());
 	const Delta deltas(std::string("-") + cfg["staff.access"]);
-	chan.flags(user,deltas);
+	lictor.flags(chan,user,deltas);
 	set_effect(deltas);
 }
 
@@ -852,7 +1001,7 @@ void vote::Mode::passed()
 	const Deltas deltas(get_issue(),serv);
 
 	auto &chan(get_chan());
-	chan(deltas);
+	lictor(chan,deltas);
 	set_effect(deltas);
 }
 
@@ -884,7 +1033,7 @@ void vote::Appeal::passed()
 	const Deltas deltas(get_issue(),serv);
 
 	auto &chan(get_chan());
-	chan(deltas);
+	lictor(chan,deltas);
 	set_effect(deltas);
 }
 
@@ -1027,6 +1176,7 @@ void vote::Config::passed()
 	else throw Exception("Configuration update could not be parsed");
 
 	chan.set(cfg);
+	confs.invalidate(chan);
 }
 
 
@@ -1104,5 +1254,5 @@ void ModeEffect::expired()
 		if(!serv.mode_has_arg(char(d),bool(d)) && !get<d.MASK>(d).empty())
 			get<d.MASK>(d).clear();
 
-	chan(deltas);
+	lictor(chan,deltas);
 }
@@ -387,6 +387,24 @@ namespace vote
 		                              AcctIssue("civis",std::forward<Args>(args)...) {}
 	};
 
+	// The issue is a batch of accounts enfranchised on one ballot. Those who may
+	// veto the vote may instead strike single accounts from the batch.
+	class Cives : public virtual Vote
+	{
+		std::vector<std::string> strikes(const std::string &acct) const;   // Accounts striking acct
+		std::vector<std::string> admitted() const;                         // Accounts of the issue not struck
+
+		void passed() override;
+		void expired() override;
+		void starting() override;
+
+	  public:
+		size_t strike(const User &user, const std::string &acct);         // Returns strikes against acct
+
+		template<class... Args> Cives(Args&&... args):
+		                              Vote("cives",std::forward<Args>(args)...) {}
+	};
+
 	class Censure : public virtual Vote,
 	                public virtual AcctIssue
 	{
@@ -505,13 +523,8 @@ template<class... Args>
 ForNow::ForNow(Args&&... args):
 Vote(std::forward<Args>(args)...)
 {
-	const auto &cfg(get_cfg());
-	if(secs_cast(cfg["for"]) != 0)
-	{
-		auto cpy(cfg);
-		cpy.put("for",0);
-		set_cfg(cpy);
-	}
+	if(get_conf().for_ != 0)
+		set_cfg("for",0);
 }
 
 
@@ -12,7 +12,11 @@ using namespace irc::bot;
 
 // SPQF
 #include "log.h"
+#include "praeco.h"
+#include "lictor.h"
+#include "confs.h"
 #include "vote.h"
+#include "census.h"
 #include "votes.h"
 #include "vdb.h"
 #include "praetor.h"
@@ -21,12 +25,14 @@ using namespace irc::bot;
 
 Voting::Voting(Bot &bot,
                Vdb &vdb,
-               Praetor &praetor):
+               Praetor &praetor,
+               const Adoc &handoff):
 bot(bot),
 vdb(vdb),
 praetor(praetor),
 interrupted(false),
 initialized(false),
+handed(handoff),
 poll_thread(&Voting::poll_worker,this),
 remind_thread(&Voting::remind_worker,this),
 eligible_thread(&Voting::eligible_worker,this)
@@ -44,6 +50,22 @@ Voting::~Voting() noexcept
 }
 
 
+Adoc Voting::handoff()
+const
+{
+	Adoc ret;
+	if(!initialized.load(std::memory_order_consume))
+		return ret;
+
+	Adoc ids;
+	for(const auto &p : votes)
+		ids.push(lex_cast(p.first));
+
+	ret.put_child("votes",ids);
+	return ret;
+}
+
+
 void Voting::cancel(const id_t &id,
                     const Chan &chan,
                     const User &user)
@@ -74,7 +96,7 @@ void Voting::cancel(Vote &vote,
 
 void Voting::valid_motion(const Vote &vote)
 {
-	const auto &cfg(vote.get_cfg());
+	const auto &cfg(vote.get_conf());
 	const auto &user(vote.get_user());
 	const auto &chan(vote.get_chan());
 	valid_limits(vote,chan,user);
@@ -82,16 +104,16 @@ void Voting::valid_motion(const Vote &vote)
 	if(!speaker(cfg,chan,user))
 		throw Exception("You are not able to create votes on this channel.");
 
-	if(!enfranchised(cfg,chan,user))
+	if(!census.enfranchised(cfg,chan,user))
 		throw Exception("You are not yet enfranchised in this channel.");
 
-	if(!qualified(cfg,chan,user))
+	if(!census.qualified(cfg,chan,user))
 		throw Exception("You have not been participating enough to start a vote.");
 
 	const auto now(time(nullptr));
-	if(cfg.has("limit.motion"))
+	if(cfg.limit.has_motion)
 	{
-		const auto limit(secs_cast(cfg["limit.motion"]));
+		const auto &limit(cfg.limit.motion);
 		const Vdb::Terms query
 		{
 			Vdb::Term { "ended",  ">=", lex_cast(now - limit)  },
@@ -100,12 +122,11 @@ void Voting::valid_motion(const Vote &vote)
 			Vdb::Term { "chan",   "==", chan.get_name()        },
 		};
 
-		if(!vdb.query(query,1).empty())
+		if(!vdb.query(chan.get_name(),query,1).empty())
 			throw Exception("This vote was made within the last ") << secs_cast(limit) << ". Try again later.";
 	}
 
-	const Adoc reasons(cfg.get_child("limit.reason",Adoc{}));
-	reasons.for_each([this,&chan,&vote,&now]
+	cfg.limit.reason.for_each([this,&chan,&vote,&now]
 	(const std::string &reason, const std::string &limit_str)
 	{
 		if(reason.size() > 64 || !isalpha(reason))
@@ -121,7 +142,7 @@ void Voting::valid_motion(const Vote &vote)
 			Vdb::Term { "chan",   "==", chan.get_name()        },
 		};
 
-		if(!vdb.query(query,1).empty())
+		if(!vdb.query(chan.get_name(),query,1).empty())
 			throw Exception("This vote failed with the reason '") << reason << "' within the last " << secs_cast(limit) << ". Try again later.";
 	});
 }
@@ -131,16 +152,14 @@ void Voting::valid_limits(const Vote &vote,
                           const Chan &chan,
                           const User &user)
 {
-	using limits = std::numeric_limits<uint8_t>;
-
 	if(user.is_myself() || chan.users.mode(user).has('o'))
 		return;
 
-	const auto &cfg(vote.get_cfg());
-	if(count(chan) > cfg.get<uint8_t>("limit.active",limits::max()))
+	const auto &cfg(vote.get_conf());
+	if(count(chan) > cfg.limit.active)
 		throw Exception("Too many active votes for this channel.");
 
-	if(count(chan,user) > cfg.get<uint8_t>("limit.user",limits::max()))
+	if(count(chan,user) > cfg.limit.user)
 		throw Exception("Too many active votes started by you on this channel.");
 
 	valid_limits_type(vote,chan,user,cfg);
@@ -150,24 +169,15 @@ void Voting::valid_limits(const Vote &vote,
 void Voting::valid_limits_type(const Vote &vote,
                                const Chan &chan,
                                const User &user,
-                               const Adoc &cfg)
+                               const VoteConfig &cfg)
 {
-	using limits = std::numeric_limits<uint8_t>;
-
 	if(vote.get_type() == "appeal")
 		return;
 
 	if(vote.get_type() == "trial")
 		return;
 
-	auto typcnt(0);
-	for_each(chan,user,[&typcnt,&vote]
-	(const Vote &active)
-	{
-		typcnt += active.get_type() == vote.get_type();
-	});
-
-	if(typcnt > cfg.get<uint8_t>("limit.type",limits::max()))
+	if(count(chan,user,vote.get_type()) > cfg.limit.type)
 		throw Exception("Too many active votes of this type started by you on this channel.");
 }
 
@@ -201,7 +211,7 @@ void Voting::eligible_add()
 void Voting::eligible_add(Chan &chan)
 try
 {
-	const auto civis(chan.get("config.vote.civis"));
+	const Adoc civis(confs.get(chan).get_child("civis",Adoc{}));
 	const auto age(secs_cast(civis["eligible.age"]));
 	const auto lines(civis.get<uint>("eligible.lines",0));
 	const auto automat(civis.get<bool>("eligible.automatic",0));
@@ -239,6 +249,7 @@ try
 		return true;
 	});
 
+	std::vector<std::pair<std::string, std::string>> eligible;    // acct, nick
 	for(const auto &p : count) try
 	{
 		const auto &acct(p.first);
@@ -261,14 +272,7 @@ try
 		if(chan.lists.has_flag(user,'V'))
 			continue;
 
-		bool exists(false);
-		for_each([&exists,&acct](const Vote &vote)
-		{
-			if(vote.get_type() == "civis" && vote.get_issue() == acct)
-				exists = true;
-		});
-
-		if(exists)
+		if(duplicated(chan.get_name(),"civis",acct))
 			continue;
 
 		const auto ids =
@@ -312,18 +316,49 @@ try
 				continue;
 		}
 
-		const auto &sess(get_sess());
-		auto &myself(users.get(sess.get_nick()));
-		const auto &vote(motion<vote::Civis>(chan,myself,nick));
-		user << "You are now eligible to be a citizen of " << chan.get_name() << "! ";
-		user << " Remind people to vote for issue #" << vote.get_id() << "!";
-		user << user.flush;
+		eligible.emplace_back(acct,nick);
 	}
 	catch(const std::exception &e)
 	{
 		std::cerr << "Error on: [" << p.first << " : " << p.second << "]: " << e.what() << std::endl;
 	}
 
+	// Up to eligible.bulk accounts share one ballot; a lone account keeps its own civis motion
+	const auto bulk(std::max(civis.get<uint>("eligible.bulk",16),1U));
+	const auto &sess(get_sess());
+	auto &myself(get_users().get(sess.get_nick()));
+	for(size_t i(0); i < eligible.size(); i += bulk) try
+	{
+		const auto begin(eligible.begin() + i);
+		const auto end(eligible.begin() + std::min(i + bulk,eligible.size()));
+
+		std::vector<std::string> accts;
+		std::transform(begin,end,std::back_inserter(accts),[]
+		(const auto &p)
+		{
+			return p.first;
+		});
+
+		const auto id(accts.size() > 1? motion<vote::Cives>(chan,myself,detok(accts.begin(),accts.end())).get_id():
+		                                motion<vote::Civis>(chan,myself,begin->second).get_id());
+
+		std::for_each(begin,end,[&chan,&id]
+		(const auto &p)
+		{
+			praeco(Praeco::REPLY,p.second,[nick(p.second),name(chan.get_name()),id]
+			{
+				auto &user(get_users().get(nick));
+				user << "You are now eligible to be a citizen of " << name << "! ";
+				user << " Remind people to vote for issue #" << id << "!";
+				user << user.flush;
+			});
+		});
+	}
+	catch(const std::exception &e)
+	{
+		std::cerr << "Error on bulk civis from [" << eligible.at(i).first << "]: " << e.what() << std::endl;
+	}
+
 	std::cout << "Finished eligible for channel " << chan.get_name() << std::endl;
 }
 catch(const std::exception &e)
@@ -361,12 +396,7 @@ void Voting::remind_worker()
 
 void Voting::remind_votes()
 {
-	using namespace colors;
-
 	const std::unique_lock<Bot> lock(bot);
-	static const milliseconds delay(750);
-	//const FloodGuard guard(bot.sess,delay);
-
 	const auto &chans(get_chans());
 	for(auto it(votes.cbegin()); it != votes.cend(); ++it)
 	{
@@ -378,24 +408,34 @@ void Voting::remind_votes()
 		if(!cfg.get("remind.enable",false))
 			continue;
 
+		const auto &conf(vote.get_conf());
+		const auto closes(time(nullptr) + vote.remaining());
 		auto &chan(vote.get_chan());
 		chan.users.for_each([&](User &user)
 		{
 			if(vote.voted(user))
 				return;
 
-			if(!enfranchised(cfg,chan,user))
+			if(!census.enfranchised(conf,chan,user))
 				return;
 
-			user << user.PRIVMSG << chan << user.get_nick() << ", I see you have not yet voted on issue "
-			     << vote << ", " << BOLD << vote.get_type() << OFF << ": " << UNDER2 << vote.get_issue() << OFF << ". "
-			     << "Your participation as a citizen of " << chan.get_name() << " is highly valued to maintain a fair and democratic community. "
-			     << "Please consider " << BOLD << FG::GREEN << "!v y " << vote.get_id() << OFF << " or " << BOLD << FG::RED << "!v n " << vote.get_id() << OFF
-			     << " before the issue closes in " << BOLD << secs_cast(vote.remaining()) << OFF << ". "
-			     << user.flush;
-
-			// TODO: fix guard
-			std::this_thread::sleep_for(delay);
+			// The herald paces these behind everything else and sheds them first
+			const auto merge("remind " + lex_cast(vote.get_id()) + " " + user.get_acct());
+			praeco(Praeco::REMIND,user.get_nick(),[nick(user.get_nick()),name(chan.get_name()),
+			                                       id(vote.get_id()),type(vote.get_type()),
+			                                       issue(vote.get_issue()),closes]
+			{
+				using namespace colors;
+
+				auto &user(get_users().get(nick));
+				auto &chan(get_chans().get(name));
+				user << user.PRIVMSG << chan << user.get_nick() << ", I see you have not yet voted on issue "
+				     << "#" << BOLD << id << OFF << ", " << BOLD << type << OFF << ": " << UNDER2 << issue << OFF << ". "
+				     << "Your participation as a citizen of " << name << " is highly valued to maintain a fair and democratic community. "
+				     << "Please consider " << BOLD << FG::GREEN << "!v y " << id << OFF << " or " << BOLD << FG::RED << "!v n " << id << OFF
+				     << " before the issue closes in " << BOLD << secs_cast(std::max(closes - time(nullptr),time_t(0))) << OFF << ". "
+				     << user.flush;
+			},merge);
 		});
 	}
 }
@@ -425,6 +465,12 @@ void Voting::poll_init()
 {
 	const std::lock_guard<Bot> lock(bot);
 	bot.set_tls_context();
+	if(handed.has("votes"))
+	{
+		poll_adopt();
+		return;
+	}
+
 	std::cout << "[Voting]: Adding previously open votes."
 	          << " Reading " << vdb.count() << " votes..."
 	          << std::endl;
@@ -441,11 +487,7 @@ void Voting::poll_init()
 			std::cout << "Adding open vote #" << id << std::endl;
 			auto vote(vdb.get(id));
 			const auto iit(votes.emplace(id,std::move(vote)));
-			{
-				const auto &vote(*iit.first->second);
-				chanidx.emplace(vote.get_chan_name(),id);
-				useridx.emplace(vote.get_user_acct(),id);
-			}
+			index(*iit.first->second);
 		}
 	}
 	catch(const std::exception &e)
@@ -458,9 +500,38 @@ void Voting::poll_init()
 }
 
 
+void Voting::poll_adopt()
+{
+	const auto ids(handed.get_child("votes",Adoc{}));
+	std::cout << "[Voting]: Adopting " << ids.size() << " open votes from the previous module."
+	          << std::endl;
+
+	for(const auto &p : ids)
+	{
+		const auto id(lex_cast<id_t>(p.second.get("",std::string{})));
+		try
+		{
+			auto vote(vdb.get(id));
+			if(vote->get_ended())
+				continue;
+
+			const auto iit(votes.emplace(id,std::move(vote)));
+			index(*iit.first->second);
+		}
+		catch(const std::exception &e)
+		{
+			std::cerr << "[Voting]: Failed adopting #" << id
+			          << ": \033[1;31m" << e.what()
+			          << "\033[0m" << std::endl;
+		}
+	}
+}
+
+
 void Voting::poll_votes()
 {
 	const std::unique_lock<Bot> lock(bot);
+	const Lictor::Batch batch(lictor);        // Votes finishing in the same tick share MODE lines
 	const auto &chans(get_chans());
 	for(auto it(votes.begin()); it != votes.end();)
 	{
@@ -476,15 +547,25 @@ void Voting::poll_votes()
 		{
 			call_finish(vote);
 			praetor.add(std::move(del(it++)));
+			continue;
 		}
-		else ++it;
+
+		if(chans.has(vote.get_chan_name()))
+			vote.announce_ballots();
+
+		++it;
 	}
+
+	// Everything written behind since the last tick is written out, vote by vote
+	vdb.flush();
 }
 
 
 void Voting::call_finish(Vote &vote)
 noexcept try
 {
+	// Acks still held when the vote closes are summarized before its result, not lost with it
+	vote.announce_ballots(true);
 	vote.finish();
 }
 catch(const std::exception &e)
@@ -494,12 +575,15 @@ catch(const std::exception &e)
 
 	std::cerr << "[Voting]: \033[1;31m" << err.str() << "\033[0m" << std::endl;
 
-	const auto &chans(get_chans());
-	if(chans.has(vote.get_chan_name()))
+	praeco(Praeco::RESULT,vote.get_chan_name(),[name(vote.get_chan_name()),msg(err.str())]
 	{
-		Chan &chan(vote.get_chan());
-		chan << err.str() << chan.flush;
-	}
+		auto &chans(get_chans());
+		if(chans.has(name))
+		{
+			Chan &chan(chans.get(name));
+			chan << msg << chan.flush;
+		}
+	});
 }
 
 
@@ -535,12 +619,54 @@ std::unique_ptr<Vote> Voting::del(const decltype(votes.begin()) &it)
 
 	deindex(chanidx,vote->get_chan_name());
 	deindex(useridx,vote->get_user_acct());
+
+	const auto deissue([this,&id](const std::string &key)
+	{
+		const auto iit(issueidx.find(key));
+		if(iit != issueidx.end() && iit->second == id)
+			issueidx.erase(iit);
+	});
+
+	deissue(issue_key(vote->get_chan_name(),vote->get_type(),vote->get_issue()));
+	if(vote->get_type() == "cives")
+		for(const auto &acct : tokens(vote->get_issue()))
+			deissue(issue_key(vote->get_chan_name(),"civis",acct));
+
+	const auto sit(speakeridx.find({vote->get_chan_name(),vote->get_user_acct()}));
+	if(sit != speakeridx.end() && sit->second.ids.erase(id))
+	{
+		auto &speaker(sit->second);
+		if(!--speaker.types[vote->get_type()])
+			speaker.types.erase(vote->get_type());
+
+		if(speaker.ids.empty())
+			speakeridx.erase(sit);
+	}
+
 	votes.erase(it);
 
 	return std::move(vote);
 }
 
 
+void Voting::index(const Vote &vote)
+{
+	const auto &id(vote.get_id());
+	chanidx.emplace(vote.get_chan_name(),id);
+	useridx.emplace(vote.get_user_acct(),id);
+	issueidx.emplace(issue_key(vote.get_chan_name(),vote.get_type(),vote.get_issue()),id);
+
+	// Each account on a bulk civis ballot stands as the issue of a civis motion for it
+	if(vote.get_type() == "cives")
+		for(const auto &acct : tokens(vote.get_issue()))
+			issueidx.emplace(issue_key(vote.get_chan_name(),"civis",acct),id);
+
+	auto &speaker(speakeridx[{vote.get_chan_name(),vote.get_user_acct()}]);
+	if(speaker.ids.emplace(id).second)
+		++speaker.types[vote.get_type()];
+}
+
+
 template<class Duration>
 void Voting::worker_sleep(Duration&& duration)
 {
@@ -586,28 +712,28 @@ const
 id_t Voting::duplicated(const Vote &vote)
 const
 {
-	const auto pit(chanidx.equal_range(vote.get_chan_name()));
-	for(auto it(pit.first); it != pit.second; ++it)
-	{
-		const auto id(it->second);
-		const auto vit(votes.find(id));
-		if(vit == votes.end())
-			continue;
-
-		const auto &existing(*vit->second);
-		if(vote.get_id() == existing.get_id())
-			continue;
+	const auto id(duplicated(vote.get_chan_name(),vote.get_type(),vote.get_issue()));
+	return id != vote.get_id()? id : 0;
+}
 
-		if(vote.get_type() != existing.get_type())
-			continue;
 
-		if(!boost::iequals(vote.get_issue(),existing.get_issue()))
-			continue;
+id_t Voting::duplicated(const std::string &chan,
+                        const std::string &type,
+                        const std::string &issue)
+const
+{
+	const auto it(issueidx.find(issue_key(chan,type,issue)));
+	return it != issueidx.end()? it->second : 0;
+}
 
-		return existing.get_id();
-	};
 
-	return 0;
+std::string Voting::issue_key(const std::string &chan,
+                              const std::string &type,
+                              const std::string &issue)
+{
+	// Neither the channel nor the type contain a space; the issue is case-folded
+	// to match the case-insensitive comparison of issues.
+	return chan + " " + type + " " + tolower(issue);
 }
 
 
@@ -747,27 +873,45 @@ const
 }
 
 
+uint Voting::count(const Chan &chan,
+                   const User &user)
+const
+{
+	const auto speaker(get_speaker(chan,user));
+	return speaker? speaker->ids.size() : 0;
+}
+
+
+uint Voting::count(const Chan &chan,
+                   const User &user,
+                   const std::string &type)
+const
+{
+	const auto speaker(get_speaker(chan,user));
+	if(!speaker)
+		return 0;
+
+	const auto it(speaker->types.find(type));
+	return it != speaker->types.end()? it->second : 0;
+}
+
+
 std::vector<id_t> Voting::get_ids(const Chan &chan,
                                   const User &user)
 const
 {
-	const auto cpit(chanidx.equal_range(chan.get_name()));
-	if(cpit.first == cpit.second)
+	const auto speaker(get_speaker(chan,user));
+	if(!speaker)
 		return {};
 
-	const auto upit(useridx.equal_range(user.get_acct()));
-	if(upit.first == upit.second)
-		return {};
+	return { speaker->ids.begin(), speaker->ids.end() };
+}
 
-	static const auto second([](const auto &p) { return p.second; });
-	std::vector<id_t> cids(std::distance(cpit.first,cpit.second));
-	std::vector<id_t> uids(std::distance(upit.first,upit.second));
-	std::transform(cpit.first,cpit.second,cids.begin(),second);
-	std::transform(upit.first,upit.second,uids.begin(),second);
-	std::sort(cids.begin(),cids.end());
-	std::sort(uids.begin(),uids.end());
 
-	std::vector<id_t> ret(std::min(cids.size(),uids.size()));
-	std::set_intersection(cids.begin(),cids.end(),uids.begin(),uids.end(),ret.begin());
-	return ret;
+const Voting::Speaker *Voting::get_speaker(const Chan &chan,
+                                           const User &user)
+const
+{
+	const auto it(speakeridx.find({chan.get_name(),user.get_acct()}));
+	return it != speakeridx.end()? &it->second : nullptr;
 }
@@ -8,6 +8,12 @@
 
 class Voting
 {
+	struct Speaker
+	{
+		std::set<id_t> ids;                          // Votes by this account in this channel
+		std::map<std::string, uint> types;           // Number of those votes by type
+	};
+
 	Bot &bot;
 	Vdb &vdb;
 	Praetor &praetor;
@@ -15,9 +21,16 @@ class Voting
 	std::condition_variable sem;                     // Notify worker of new work
 	std::atomic<bool> interrupted;                   // Worker exits on interrupted state
 	std::atomic<bool> initialized;                   // Voting cannot begin until initialized
+	Adoc handed;                                     // State of the previous module for poll_init()
 	std::map<id_t, std::unique_ptr<Vote>> votes;     // Standing votes  : id => vote
 	std::multimap<std::string, id_t> chanidx;        // Index of votes  : chan => id
 	std::multimap<std::string, id_t> useridx;        // Index of votes  : acct => id
+	std::unordered_map<std::string, id_t> issueidx;  // Index of votes  : chan type issue => id
+	std::map<std::pair<std::string, std::string>, Speaker> speakeridx;   // Index of votes  : chan acct => Speaker
+
+	static std::string issue_key(const std::string &chan, const std::string &type, const std::string &issue);
+
+	const Speaker *get_speaker(const Chan &chan, const User &user) const;      // nullptr if none
 
   public:
 	std::vector<id_t> get_ids(const Chan &chan, const User &user) const;
@@ -47,22 +60,26 @@ class Voting
 	auto exists(const User &user) const -> bool      { return useridx.count(user.get_acct());   }
 	auto exists(const id_t &id) const -> bool        { return votes.count(id);                  }
 
-	uint count(const Chan &c, const User &u) const   { return get_ids(c,u).size();              }
+	uint count(const Chan &c, const User &u, const std::string &type) const;
+	uint count(const Chan &c, const User &u) const;
 	auto count(const Chan &chan) const               { return chanidx.count(chan.get_name());   }
 	auto count(const User &user) const               { return useridx.count(user.get_acct());   }
 	auto count() const                               { return votes.size();                     }
 
+	id_t duplicated(const std::string &chan, const std::string &type, const std::string &issue) const;
 	id_t duplicated(const Vote &vote) const;
 
   private:
 	id_t get_next_id() const;
 	void worker_wait_init();
 	template<class Duration> void worker_sleep(Duration&& duration);
+	void index(const Vote &vote);
 	std::unique_ptr<Vote> del(const decltype(votes.begin()) &it);
 	std::unique_ptr<Vote> del(const id_t &id);
 
 	void call_finish(Vote &vote) noexcept;
 	void poll_votes();
+	void poll_adopt();
 	void poll_init();
 	void poll_sleep();
 	void poll_worker();
@@ -79,7 +96,7 @@ class Voting
 	void eligible_worker();
 	std::thread eligible_thread;
 
-	void valid_limits_type(const Vote &vote, const Chan &chan, const User &user, const Adoc &cfg);
+	void valid_limits_type(const Vote &vote, const Chan &chan, const User &user, const VoteConfig &cfg);
 	void valid_limits(const Vote &vote, const Chan &chan, const User &user);
 	void valid_motion(const Vote &vote);
 
@@ -88,7 +105,9 @@ class Voting
 	void cancel(const id_t &id, const Chan &chan, const User &user);
 	template<class Vote, class... Args> Vote &motion(Args&&... args);
 
-	Voting(Bot &bot, Vdb &vdb, Praetor &praetor);
+	Adoc handoff() const;                            // Open votes for the next module; empty until initialized
+
+	Voting(Bot &bot, Vdb &vdb, Praetor &praetor, const Adoc &handoff = {});
 	Voting(const Voting &) = delete;
 	Voting &operator=(const Voting &) = delete;
 	~Voting() noexcept;
@@ -110,8 +129,13 @@ try
 		auto &ptr(iit.first->second);
 		auto &vote(dynamic_cast<Vote &>(*ptr));
 
-		// For duplicate, cast YEA ballot and remove this motion
+		// A yea folded into a bulk ballot would count for every account on it, not only this one
 		const auto dup_id(duplicated(vote));
+		if(dup_id && get(dup_id).get_type() != vote.get_type())
+			throw Exception() << "This is already at issue in bulk vote #" << dup_id << "."
+			                  << " Vote on that, or object with: !vote strike " << dup_id << " <account>";
+
+		// For duplicate, cast YEA ballot and remove this motion
 		if(dup_id)
 		{
 			auto &existing(dynamic_cast<Vote &>(get(dup_id)));
@@ -121,8 +145,7 @@ try
 			return existing;
 		}
 
-		chanidx.emplace(vote.get_chan_name(),id);
-		useridx.emplace(vote.get_user_acct(),id);
+		index(vote);
 		valid_motion(vote);
 		vote.start();
 		sem.notify_one();